@@ -1,121 +1,207 @@
-#pragma once
-#include <iostream>
-#include <string>
-#include <stdexcept>
-
-using namespace std;
-
-class ATM
-{
-private:
-    std::string currentAccount;
-    double balance;
-    double cashAvailable;
-    bool authenticated;
-    std::string currentPIN;
-
-public:
-    ATM() : balance(5000), cashAvailable(10000), authenticated(false), currentPIN("1234") {}
-
-    // Basic ATM functions
-    void insertCard(const std::string &accountNumber)
-    {
-        if (accountNumber.empty())
-        {
-            throw std::invalid_argument("Account number cannot be empty");
-        }
-        currentAccount = accountNumber;
-        authenticated = false;
-    }
-
-    bool enterPIN(const std::string &pin)
-    {
-        if (pin.length() != 4)
-        {
-            throw std::invalid_argument("PIN must be 4 digits");
-        }
-        authenticated = (pin == currentPIN);
-        return authenticated;
-    }
-
-    double checkBalance() const
-    {
-        if (!authenticated)
-        {
-            throw std::runtime_error("Please login first");
-        }
-        return balance;
-    }
-
-    void withdraw(double amount)
-    {
-        if (!authenticated)
-        {
-            throw std::runtime_error("Please login first");
-        }
-        if (amount <= 0)
-        {
-            throw std::invalid_argument("Amount must be positive");
-        }
-        if (amount > balance)
-        {
-            throw std::runtime_error("Insufficient funds");
-        }
-        if (amount > cashAvailable)
-        {
-            throw std::runtime_error("Not enough cash in ATM");
-        }
-        balance -= amount;
-        cashAvailable -= amount;
-    }
-
-    void deposit(double amount)
-    {
-        if (!authenticated)
-        {
-            throw std::runtime_error("Please login first");
-        }
-        if (amount <= 0)
-        {
-            throw std::invalid_argument("Amount must be positive");
-        }
-        balance += amount;
-        cashAvailable += amount;
-    }
-
-    bool changePIN(const std::string &oldPin, const std::string &newPin)
-    {
-        if (!authenticated)
-        {
-            throw std::runtime_error("Please login first");
-        }
-        if (oldPin != currentPIN)
-        {
-            return false;
-        }
-        if (newPin.length() != 4)
-        {
-            throw std::invalid_argument("New PIN must be 4 digits");
-        }
-        currentPIN = newPin;
-        return true;
-    }
-
-    void endSession()
-    {
-        authenticated = false;
-        currentAccount = "";
-    }
-
-    // Admin functions
-    void refillMachine(double amount)
-    {
-        if (amount <= 0)
-        {
-            throw std::invalid_argument("Amount must be positive");
-        }
-        cashAvailable += amount;
-    }
-
-    double getCashAvailable() const { return cashAvailable; }
+#pragma once
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <ctime>
+#include <unordered_map>
+#include <future>
+#include "../Common/SlidingWindow.hpp"
+#include "../Common/Credentials.hpp"
+#include "../Common/LockoutTable.hpp"
+#include "../Common/Trace.hpp"
+
+using namespace std;
+
+class ATM
+{
+private:
+    std::string currentAccount;
+    Money balance;
+    Money cashAvailable;
+    bool authenticated;
+    std::string pinHash;          // salted PBKDF2, see Credentials.hpp
+    CredentialVerifier &verifier;
+    LockoutTable &lockouts;       // failed PIN attempts per card
+
+    // Per-card withdrawals over the last 24h (1h buckets)
+    std::unordered_map<std::string, SlidingWindow<24, 3600>> withdrawalWindows;
+    long long maxWithdrawalsPerDay;
+    Money maxWithdrawalAmountPerDay;
+
+public:
+    ATM(CredentialVerifier &pool = CredentialVerifier::shared(), LockoutTable &cardLockouts = LockoutTable::shared())
+        : balance(moneyUnits(5000)), cashAvailable(moneyUnits(10000)), authenticated(false),
+          pinHash(hashCredential("1234")), verifier(pool), lockouts(cardLockouts),
+          maxWithdrawalsPerDay(5), maxWithdrawalAmountPerDay(moneyUnits(2000)) {}
+
+    // Basic ATM functions
+    void insertCard(const std::string &accountNumber)
+    {
+        TRACE_SCOPE("ATM::insertCard", 0);
+        if (accountNumber.empty())
+        {
+            throw std::invalid_argument("Account number cannot be empty");
+        }
+        currentAccount = accountNumber;
+        authenticated = false;
+    }
+
+private:
+    // Queues a check of `pin` against the card's PIN. The attempt counts
+    // against the card's lockout from the moment it is queued and is cleared
+    // only if the PIN was right, so guesses still in flight count too.
+    std::future<bool> checkPIN(const std::string &pin)
+    {
+        std::string card = currentAccount;
+        if (!lockouts.beginAttempt(card, time(nullptr)))
+        {
+            throw std::runtime_error("Card locked after too many wrong PINs, try again later");
+        }
+        LockoutTable &table = lockouts;
+        try
+        {
+            return verifier.verify(pin, pinHash, [&table, card](bool ok)
+            {
+                if (ok)
+                {
+                    table.recordSuccess(card);
+                }
+            });
+        }
+        catch (...)
+        {
+            lockouts.cancelAttempt(card);
+            throw;
+        }
+    }
+
+public:
+    // Queues the PIN check on the verifier pool and returns at once; pass
+    // the future to finishPIN() to complete the login. Throws if the card is
+    // locked out or the pool is saturated.
+    std::future<bool> enterPINAsync(const std::string &pin)
+    {
+        TRACE_SCOPE("ATM::enterPINAsync", 0);
+        if (pin.length() != 4)
+        {
+            throw std::invalid_argument("PIN must be 4 digits");
+        }
+        authenticated = false;
+        return checkPIN(pin);
+    }
+
+    bool finishPIN(std::future<bool> &pending)
+    {
+        TRACE_SCOPE("ATM::finishPIN", 0);
+        authenticated = pending.get();
+        return authenticated;
+    }
+
+    bool enterPIN(const std::string &pin)
+    {
+        std::future<bool> pending = enterPINAsync(pin);
+        return finishPIN(pending);
+    }
+
+    Money checkBalance() const
+    {
+        TRACE_SCOPE("ATM::checkBalance", 0);
+        if (!authenticated)
+        {
+            throw std::runtime_error("Please login first");
+        }
+        return balance;
+    }
+
+    void withdraw(Money amount)
+    {
+        TRACE_SCOPE("ATM::withdraw", 0);
+        if (!authenticated)
+        {
+            throw std::runtime_error("Please login first");
+        }
+        if (amount <= 0)
+        {
+            throw std::invalid_argument("Amount must be positive");
+        }
+        if (amount > balance)
+        {
+            throw std::runtime_error("Insufficient funds");
+        }
+        if (amount > cashAvailable)
+        {
+            throw std::runtime_error("Not enough cash in ATM");
+        }
+        time_t now = time(nullptr);
+        SlidingWindow<24, 3600> &window = withdrawalWindows[currentAccount];
+        if (!window.allows(now, amount, maxWithdrawalsPerDay, maxWithdrawalAmountPerDay))
+        {
+            throw std::runtime_error("Daily withdrawal limit exceeded");
+        }
+        balance -= amount;
+        cashAvailable -= amount;
+        window.record(now, amount);
+    }
+
+    void deposit(Money amount)
+    {
+        TRACE_SCOPE("ATM::deposit", 0);
+        if (!authenticated)
+        {
+            throw std::runtime_error("Please login first");
+        }
+        if (amount <= 0)
+        {
+            throw std::invalid_argument("Amount must be positive");
+        }
+        balance += amount;
+        cashAvailable += amount;
+    }
+
+    // The old PIN is checked like a login, lockout included, and the new
+    // one hashed on the verifier pool
+    bool changePIN(const std::string &oldPin, const std::string &newPin)
+    {
+        TRACE_SCOPE("ATM::changePIN", 0);
+        if (!authenticated)
+        {
+            throw std::runtime_error("Please login first");
+        }
+        if (newPin.length() != 4)
+        {
+            throw std::invalid_argument("New PIN must be 4 digits");
+        }
+        if (!checkPIN(oldPin).get())
+        {
+            return false;
+        }
+        pinHash = verifier.hash(newPin).get();
+        return true;
+    }
+
+    void endSession()
+    {
+        authenticated = false;
+        currentAccount = "";
+    }
+
+    // Admin functions
+    void refillMachine(Money amount)
+    {
+        TRACE_SCOPE("ATM::refillMachine", 0);
+        if (amount <= 0)
+        {
+            throw std::invalid_argument("Amount must be positive");
+        }
+        cashAvailable += amount;
+    }
+
+    // A negative limit disables it
+    void setWithdrawalLimits(long long maxCount, Money maxAmount)
+    {
+        maxWithdrawalsPerDay = maxCount;
+        maxWithdrawalAmountPerDay = maxAmount;
+    }
+
+    Money getCashAvailable() const { return cashAvailable; }
 };
\ No newline at end of file
@@ -1,79 +1,177 @@
-#pragma once
-#include "User.hpp"
-#include "ATM.hpp"
-#include <iostream>
-
-class ATMAdmin : public User
-{
-private:
-    ATM &atm;
-
-public:
-    ATMAdmin(ATM &atmMachine, const std::string &uname, const std::string &pwd)
-        : User(uname, pwd), atm(atmMachine) {}
-
-    bool login(const std::string &uname, const std::string &pwd) override
-    {
-        return (username == uname && password == pwd);
-    }
-
-    void showMenu() override
-    {
-        std::cout << "\n===== Admin Menu =====" << std::endl;
-        std::cout << "1. Refill Cash" << std::endl;
-        std::cout << "2. View ATM Cash" << std::endl;
-        std::cout << "3. Perform Maintenance" << std::endl;
-        std::cout << "4. Logout" << std::endl;
-    }
-
-    void performAction(int choice) override
-    {
-        try
-        {
-            switch (choice)
-            {
-            case 1:
-            {
-                double amount;
-                std::cout << "Enter amount to refill: ";
-                std::cin >> amount;
-                atm.refillMachine(amount);
-                std::cout << "Refill successful. Current cash: " << atm.getCashAvailable() << std::endl;
-                break;
-            }
-            case 2:
-            {
-                std::cout << "ATM Cash Available: " << atm.getCashAvailable() << std::endl;
-                break;
-            }
-            case 3:
-            {
-                std::cout << "Performing maintenance..." << std::endl;
-                // Simulate maintenance
-                for (int i = 0; i < 3; ++i)
-                {
-                    std::cout << ".";
-                    std::cout.flush();
-                    // Simulate delay
-                    for (int j = 0; j < 100000000; ++j)
-                    {
-                    }
-                }
-                std::cout << "\nMaintenance completed" << std::endl;
-                break;
-            }
-            case 4:
-            {
-                std::cout << "Logged out from admin system" << std::endl;
-                break;
-            }
-            default:
-                std::cout << "Invalid choice!" << std::endl;
-            }
-        }
-        catch (const std::exception &e)
-        {
-            std::cerr << "Error: " << e.what() << std::endl;
-        }
-    }
+#pragma once
+#include "User.hpp"
+#include "ATM.hpp"
+#include "FleetSimulator.hpp"
+#include <iostream>
+#include <iomanip>
+
+class ATMAdmin : public User
+{
+private:
+    ATM &atm;
+
+public:
+    ATMAdmin(ATM &atmMachine, const std::string &uname, const std::string &pwd)
+        : User(uname, pwd), atm(atmMachine) {}
+
+    bool login(const std::string &uname, const std::string &pwd) override
+    {
+        try
+        {
+            return username == uname && CredentialVerifier::shared().verify(pwd, password).get();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    void showMenu() override
+    {
+        std::cout << "\n===== Admin Menu =====" << std::endl;
+        std::cout << "1. Refill Cash" << std::endl;
+        std::cout << "2. View ATM Cash" << std::endl;
+        std::cout << "3. Perform Maintenance" << std::endl;
+        std::cout << "4. Fleet Refill Planner" << std::endl;
+        std::cout << "5. Flush Trace" << std::endl;
+        std::cout << "6. Logout" << std::endl;
+    }
+
+    // Simulates a year of demand across a fleet that starts with this
+    // machine's cash level and prints the resulting refill plan
+    void planFleetRefills()
+    {
+        FleetConfig config;
+        std::string source;
+        double targetPercent = 0;
+        std::cout << "Number of machines: ";
+        if (!(std::cin >> config.machines) || config.machines == 0)
+        {
+            std::cin.clear();
+            throw std::invalid_argument("Invalid number of machines");
+        }
+        std::cout << "Allowed out-of-cash time (% of hours): ";
+        if (!(std::cin >> targetPercent) || !(targetPercent >= 0 && targetPercent <= 100))
+        {
+            std::cin.clear();
+            throw std::invalid_argument("Out-of-cash time must be between 0 and 100%");
+        }
+        std::cout << "Withdrawal log CSV (machine,hour,amount) or - for synthetic demand: ";
+        std::cin >> source;
+        config.targetOutOfCash = targetPercent / 100;
+
+        FleetSimulator simulator(config, moneyToDouble(atm.getCashAvailable()));
+        if (source != "-")
+        {
+            simulator.loadWithdrawals(source);
+        }
+
+        std::vector<int> cashOut = simulator.forecastCashOut();
+        size_t dry = 0;
+        int first = -1;
+        for (int hour : cashOut)
+        {
+            if (hour >= 0)
+            {
+                dry++;
+                first = first < 0 ? hour : std::min(first, hour);
+            }
+        }
+        std::cout << "\nWithout refills " << dry << " of " << config.machines << " machines run out";
+        if (first >= 0)
+        {
+            std::cout << ", first after " << first << " hours";
+        }
+        std::cout << std::endl;
+
+        FleetRun plan = simulator.plan();
+        std::cout << std::fixed << std::setprecision(2);
+        if (!plan.targetMet)
+        {
+            std::cout << "Target not met: even the largest safety factor tried leaves machines dry "
+                      << "longer than allowed. Plan with the largest one:" << std::endl;
+        }
+        std::cout << "Safety factor:      " << plan.safetyFactor << " x lead time" << std::endl;
+        std::cout << "Refills per year:   " << plan.refills << std::endl;
+        std::cout << "Out-of-cash events: " << plan.outOfCashEvents << std::endl;
+        std::cout << "Out-of-cash time:   " << plan.outOfCashRate * 100 << "%" << std::endl;
+        std::cout << "First refills:" << std::endl;
+        for (size_t i = 0; i < plan.schedule.size() && i < 10; i++)
+        {
+            std::cout << "  Machine " << plan.schedule[i].machine << " on day " << plan.schedule[i].hour / 24 + 1
+                      << " at " << plan.schedule[i].hour % 24 << ":00" << std::endl;
+        }
+    }
+
+    void performAction(int choice) override
+    {
+        try
+        {
+            switch (choice)
+            {
+            case 1:
+            {
+                Money amount;
+                std::cout << "Enter amount to refill: ";
+                if (!readMoney(std::cin, amount))
+                {
+                    std::cin.clear();
+                    throw std::invalid_argument("Invalid amount");
+                }
+                atm.refillMachine(amount);
+                std::cout << "Refill successful. Current cash: " << formatMoney(atm.getCashAvailable()) << std::endl;
+                break;
+            }
+            case 2:
+            {
+                std::cout << "ATM Cash Available: " << formatMoney(atm.getCashAvailable()) << std::endl;
+                break;
+            }
+            case 3:
+            {
+                std::cout << "Performing maintenance..." << std::endl;
+                // Simulate maintenance
+                for (int i = 0; i < 3; ++i)
+                {
+                    std::cout << ".";
+                    std::cout.flush();
+                    // Simulate delay
+                    for (int j = 0; j < 100000000; ++j)
+                    {
+                    }
+                }
+                std::cout << "\nMaintenance completed" << std::endl;
+                break;
+            }
+            case 4:
+            {
+                planFleetRefills();
+                break;
+            }
+            case 5:
+            {
+#ifdef ENABLE_TRACING
+                size_t events = Trace::flush("atm.trace");
+                Trace::toChromeJson("atm.trace", "atm.trace.json");
+                std::cout << events << " events written to atm.trace (Chrome/Perfetto: atm.trace.json)" << std::endl;
+#else
+                std::cout << "Tracing is not compiled in. Rebuild with -DENABLE_TRACING." << std::endl;
+#endif
+                break;
+            }
+            case 6:
+            {
+                std::cout << "Logged out from admin system" << std::endl;
+                break;
+            }
+            default:
+                std::cout << "Invalid choice!" << std::endl;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,368 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FleetConfig
+{
+    size_t machines = 10000;
+    int days = 365;
+    double capacity = 10000;          // cash after a refill
+    double meanHourlyDemand = 40;     // fleet average; each machine gets its own level
+    int refillLeadHours = 24;         // from ordering a refill to the cash arriving
+    double targetOutOfCash = 0.005;   // allowed fraction of machine-hours without cash
+    unsigned threads = 0;             // 0 = one per hardware thread
+    std::uint64_t seed = 42;
+};
+
+struct RefillOrder
+{
+    std::uint32_t machine;
+    std::uint32_t hour;               // when the cash arrives
+};
+
+struct FleetRun
+{
+    double safetyFactor = 0;
+    double outOfCashRate = 0;         // fraction of machine-hours without cash
+    size_t outOfCashEvents = 0;       // times a machine ran dry
+    size_t refills = 0;
+    bool targetMet = false;           // outOfCashRate within FleetConfig::targetOutOfCash
+    std::vector<RefillOrder> schedule;
+};
+
+// Recorded withdrawals, replayed instead of synthetic demand
+struct WithdrawalRecord
+{
+    std::uint32_t machine;
+    std::uint32_t hour;
+    double amount;
+};
+
+// Discrete-time (hourly) cash simulation for a fleet of ATMs.
+//
+// Machine state is kept as parallel arrays and every hour is one pass over
+// them, so the update is a straight, branch-free loop. Machines are
+// independent, so the fleet is split into ranges that run on separate
+// threads; each machine has its own random stream, so results do not depend
+// on the thread count.
+//
+// Refill policy: each machine tracks its recent demand rate; when the
+// forecast time to empty drops below safetyFactor * lead time, a refill is
+// ordered and arrives lead time later. plan() searches for the smallest
+// safety factor that keeps out-of-cash time under the target.
+class FleetSimulator
+{
+private:
+    FleetConfig config;
+    std::vector<double> initialCash;
+    std::vector<double> baseDemand;
+    std::vector<WithdrawalRecord> recorded;   // sorted by machine, then hour
+    std::vector<size_t> recordedStart;        // first record per machine
+
+    // Share of daily demand per hour of day; sums to 24
+    static double hourProfile(int hourOfDay)
+    {
+        static const double profile[24] = {
+            0.2, 0.1, 0.1, 0.1, 0.1, 0.2, 0.5, 0.9, 1.3, 1.4, 1.5, 1.7,
+            2.0, 1.8, 1.5, 1.4, 1.5, 1.8, 1.9, 1.6, 1.1, 0.6, 0.4, 0.3};
+        return profile[hourOfDay];
+    }
+
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // 1 if x > 0, 0 if x is +0. Cash after serving and demand are never
+    // negative, so this is a compare done in integer arithmetic, which the
+    // vectorizer handles where a double compare feeding an integer does not.
+    static std::uint64_t positive(double x)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return (bits | (0 - bits)) >> 63;
+    }
+
+    struct RangeResult
+    {
+        size_t outHours = 0;
+        size_t outEvents = 0;
+        std::vector<RefillOrder> schedule;
+    };
+
+    void simulateRange(size_t begin, size_t end, double safety, bool refill, RangeResult &result,
+                       std::vector<int> *cashOut) const
+    {
+        size_t n = end - begin;
+        int hours = config.days * 24;
+        double leadHours = config.refillLeadHours;
+        const double alpha = 1.0 / 48;   // demand-rate smoothing
+
+        std::vector<double> cash(initialCash.begin() + begin, initialCash.begin() + end);
+        std::vector<double> base(baseDemand.begin() + begin, baseDemand.begin() + end);
+        std::vector<double> rate(base);
+        std::vector<double> demand(n);
+        std::vector<std::uint64_t> rng(n);
+        std::vector<std::int32_t> arrival(n, -1);
+        std::vector<std::uint8_t> dry(n, 0);
+        std::vector<size_t> cursor(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            rng[i] = mix(config.seed ^ mix(begin + i));
+            cursor[i] = recorded.empty() ? 0 : recordedStart[begin + i];
+        }
+
+        for (int hour = 0; hour < hours; hour++)
+        {
+            int hourOfDay = hour % 24;
+            double profile = hourProfile(hourOfDay) * ((hour / 24) % 7 >= 5 ? 1.3 : 1.0);
+
+            // Demand for this hour
+            if (recorded.empty())
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    rng[i] ^= rng[i] << 13;
+                    rng[i] ^= rng[i] >> 7;
+                    rng[i] ^= rng[i] << 17;
+                    double noise = 0.5 + (double)(rng[i] >> 11) * (1.0 / 9007199254740992.0);
+                    demand[i] = base[i] * profile * noise;
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    double total = 0;
+                    size_t limit = recordedStart[begin + i + 1];
+                    while (cursor[i] < limit && recorded[cursor[i]].hour == (std::uint32_t)hour)
+                    {
+                        total += recorded[cursor[i]++].amount;
+                    }
+                    demand[i] = total;
+                }
+            }
+
+            // Serve demand and update the forecast. Counts go to locals, the
+            // flags are 0/1 integer arithmetic and the arrays are read through
+            // plain pointers (the byte stores to dry could otherwise alias the
+            // vectors' own pointers), so this loop vectorizes.
+            double *cashP = cash.data();
+            double *rateP = rate.data();
+            const double *demandP = demand.data();
+            std::uint8_t *dryP = dry.data();
+            size_t outHours = 0;
+            size_t outEvents = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                double left = cashP[i] - demandP[i];
+                double now = left > 0 ? left : 0;
+                std::uint64_t empty = (positive(now) ^ 1) & positive(demandP[i]);
+                outHours += empty;
+                outEvents += empty & (dryP[i] ^ 1);
+                cashP[i] = now;
+                rateP[i] += alpha * (demandP[i] - rateP[i]);
+                dryP[i] = positive(now) ^ 1;
+            }
+            result.outHours += outHours;
+            result.outEvents += outEvents;
+
+            if (cashOut != nullptr)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    if (dry[i] && (*cashOut)[begin + i] < 0)
+                    {
+                        (*cashOut)[begin + i] = hour;
+                    }
+                }
+            }
+
+            if (!refill)
+            {
+                continue;
+            }
+
+            // Deliveries, then new orders
+            for (size_t i = 0; i < n; i++)
+            {
+                if (arrival[i] == hour)
+                {
+                    cash[i] = config.capacity;
+                    dry[i] = 0;
+                    arrival[i] = -1;
+                }
+                else if (arrival[i] < 0 && cash[i] < rate[i] * leadHours * safety)
+                {
+                    arrival[i] = hour + config.refillLeadHours;
+                    result.schedule.push_back({(std::uint32_t)(begin + i), (std::uint32_t)arrival[i]});
+                }
+            }
+        }
+    }
+
+    FleetRun simulate(double safety, bool refill, std::vector<int> *cashOut) const
+    {
+        unsigned threads = config.threads;
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = (unsigned)std::max<size_t>(1, std::min<size_t>(threads, config.machines));
+
+        std::vector<RangeResult> results(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+        {
+            size_t begin = config.machines * t / threads;
+            size_t end = config.machines * (t + 1) / threads;
+            if (t + 1 == threads)
+            {
+                simulateRange(begin, end, safety, refill, results[t], cashOut);
+            }
+            else
+            {
+                workers.emplace_back(&FleetSimulator::simulateRange, this, begin, end, safety, refill,
+                                     std::ref(results[t]), cashOut);
+            }
+        }
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+
+        FleetRun run;
+        run.safetyFactor = safety;
+        size_t outHours = 0;
+        for (auto &r : results)
+        {
+            outHours += r.outHours;
+            run.outOfCashEvents += r.outEvents;
+            run.schedule.insert(run.schedule.end(), r.schedule.begin(), r.schedule.end());
+        }
+        std::sort(run.schedule.begin(), run.schedule.end(), [](const RefillOrder &a, const RefillOrder &b)
+                  { return a.hour != b.hour ? a.hour < b.hour : a.machine < b.machine; });
+        run.refills = run.schedule.size();
+        run.outOfCashRate = (double)outHours / ((double)config.machines * config.days * 24);
+        run.targetMet = run.outOfCashRate <= config.targetOutOfCash;
+        return run;
+    }
+
+public:
+    // Every machine starts with `startingCash`
+    FleetSimulator(const FleetConfig &cfg, double startingCash)
+        : config(cfg), initialCash(cfg.machines, startingCash), baseDemand(cfg.machines)
+    {
+        if (cfg.machines == 0 || cfg.days <= 0)
+        {
+            throw std::invalid_argument("Fleet needs at least one machine and one day");
+        }
+        // Busy and quiet sites: per-machine demand level between 0.25x and 2.5x
+        for (size_t i = 0; i < cfg.machines; i++)
+        {
+            double u = (double)(mix(cfg.seed + i) >> 11) * (1.0 / 9007199254740992.0);
+            baseDemand[i] = cfg.meanHourlyDemand * (0.25 + 2.25 * u * u);
+        }
+    }
+
+    void setStartingCash(size_t machine, double cash)
+    {
+        initialCash.at(machine) = cash;
+    }
+
+    // Replays recorded withdrawals instead of synthetic demand. CSV lines of
+    // machine,hour,amount; hour counts from the start of the simulation.
+    void loadWithdrawals(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        std::vector<WithdrawalRecord> records;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            WithdrawalRecord r;
+            char comma1, comma2;
+            if (fields >> r.machine >> comma1 >> r.hour >> comma2 >> r.amount &&
+                r.machine < config.machines && r.amount > 0)
+            {
+                records.push_back(r);
+            }
+        }
+        std::sort(records.begin(), records.end(), [](const WithdrawalRecord &a, const WithdrawalRecord &b)
+                  { return a.machine != b.machine ? a.machine < b.machine : a.hour < b.hour; });
+
+        recordedStart.assign(config.machines + 1, records.size());
+        for (size_t i = records.size(); i-- > 0;)
+        {
+            recordedStart[records[i].machine] = i;
+        }
+        for (size_t m = config.machines; m-- > 0;)
+        {
+            recordedStart[m] = std::min(recordedStart[m], recordedStart[m + 1]);
+        }
+        recorded.swap(records);
+    }
+
+    // Hour each machine first runs out of cash with no refills, or -1 if it
+    // lasts the whole horizon.
+    std::vector<int> forecastCashOut() const
+    {
+        std::vector<int> cashOut(config.machines, -1);
+        simulate(0, false, &cashOut);
+        return cashOut;
+    }
+
+    FleetRun run(double safetyFactor) const
+    {
+        return simulate(safetyFactor, true, nullptr);
+    }
+
+    // Smallest safety factor (to 0.05) whose schedule meets the target. If
+    // none up to 64 does (e.g. demand outruns a full machine within the lead
+    // time), returns the run at 64 with targetMet false.
+    FleetRun plan() const
+    {
+        double low = 0.5, high = 1.0;
+        FleetRun best = run(high);
+        while (!best.targetMet && high < 64)
+        {
+            low = high;
+            high *= 2;
+            best = run(high);
+        }
+        if (!best.targetMet)
+        {
+            return best;
+        }
+        while (high - low > 0.05)
+        {
+            double mid = (low + high) / 2;
+            FleetRun candidate = run(mid);
+            if (candidate.targetMet)
+            {
+                high = mid;
+                best = std::move(candidate);
+            }
+            else
+            {
+                low = mid;
+            }
+        }
+        return best;
+    }
+};
@@ -0,0 +1,50 @@
+// Fleet cash simulation throughput as threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread FleetBench.cpp -o FleetBench && ./FleetBench [machines] [days]
+//
+// Runs one year (by default) of hourly demand with refills for a fleet of
+// machines (default 10000), once per thread count from one thread up to the
+// hardware thread count, and prints simulated machine-hours per second. Then
+// runs plan() once on all threads, which is the refill planner's whole
+// search, and prints how long it took and whether the target was met.
+#include "../FleetSimulator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+int main(int argc, char *argv[])
+{
+    FleetConfig config;
+    config.machines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    config.days = argc > 2 ? std::atoi(argv[2]) : 365;
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double machineHours = (double)config.machines * config.days * 24;
+
+    std::printf("%zu machines, %d days, up to %u threads\n", config.machines, config.days, maxThreads);
+    std::printf("%8s %12s %18s\n", "threads", "seconds", "machine-hours/s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        config.threads = threads;
+        FleetSimulator simulator(config, config.capacity);
+
+        auto start = std::chrono::steady_clock::now();
+        FleetRun run = simulator.run(2.0);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%8u %12.3f %18.0f   (%zu refills)\n", threads, seconds, machineHours / seconds, run.refills);
+        if (threads < maxThreads && threads * 2 > maxThreads)
+        {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+
+    config.threads = 0;
+    FleetSimulator simulator(config, config.capacity);
+    auto start = std::chrono::steady_clock::now();
+    FleetRun plan = simulator.plan();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("plan(): %.3f s, safety factor %.2f, out of cash %.3f%%, target %s\n", seconds, plan.safetyFactor,
+                plan.outOfCashRate * 100, plan.targetMet ? "met" : "not met");
+    return 0;
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Sha256.hpp"
+
+// Stored credentials are "pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>".
+// Plaintext PINs and passwords are never kept.
+const unsigned CREDENTIAL_ITERATIONS = 100000;
+
+namespace credential_detail
+{
+    inline std::string toHex(const std::uint8_t *data, size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(size * 2, '0');
+        for (size_t i = 0; i < size; i++)
+        {
+            out[i * 2] = digits[data[i] >> 4];
+            out[i * 2 + 1] = digits[data[i] & 15];
+        }
+        return out;
+    }
+
+    inline bool fromHex(const std::string &text, std::vector<std::uint8_t> &out)
+    {
+        if (text.size() % 2 != 0)
+        {
+            return false;
+        }
+        out.clear();
+        for (size_t i = 0; i < text.size(); i += 2)
+        {
+            int value = 0;
+            for (size_t j = i; j < i + 2; j++)
+            {
+                char c = text[j];
+                int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+                if (digit < 0)
+                {
+                    return false;
+                }
+                value = value * 16 + digit;
+            }
+            out.push_back((std::uint8_t)value);
+        }
+        return true;
+    }
+}
+
+inline bool isHashedCredential(const std::string &stored)
+{
+    return stored.compare(0, 14, "pbkdf2-sha256$") == 0;
+}
+
+// Salts and hashes a PIN or password for storage. Deliberately slow.
+inline std::string hashCredential(const std::string &secret, unsigned iterations = CREDENTIAL_ITERATIONS)
+{
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    std::uint8_t salt[16];
+    for (size_t i = 0; i < sizeof(salt); i += 8)
+    {
+        std::uint64_t r = rng();
+        std::memcpy(salt + i, &r, 8);
+    }
+    std::uint8_t hash[Sha256::DIGEST_SIZE];
+    pbkdf2Sha256(secret, salt, sizeof(salt), iterations, hash);
+    return "pbkdf2-sha256$" + std::to_string(iterations) + "$" + credential_detail::toHex(salt, sizeof(salt)) + "$" +
+           credential_detail::toHex(hash, sizeof(hash));
+}
+
+// Checks a secret against a stored credential in time independent of where
+// the hashes differ. Malformed records never match.
+inline bool verifyCredential(const std::string &secret, const std::string &stored)
+{
+    if (!isHashedCredential(stored))
+    {
+        return false;
+    }
+    size_t a = stored.find('$', 14);
+    size_t b = a == std::string::npos ? a : stored.find('$', a + 1);
+    if (b == std::string::npos)
+    {
+        return false;
+    }
+    unsigned long iterations = std::strtoul(stored.c_str() + 14, nullptr, 10);
+    std::vector<std::uint8_t> salt, expected;
+    if (iterations == 0 || iterations > 10000000 || !credential_detail::fromHex(stored.substr(a + 1, b - a - 1), salt) ||
+        salt.size() > 64 || !credential_detail::fromHex(stored.substr(b + 1), expected) ||
+        expected.size() != Sha256::DIGEST_SIZE)
+    {
+        return false;
+    }
+
+    std::uint8_t hash[Sha256::DIGEST_SIZE];
+    pbkdf2Sha256(secret, salt.data(), salt.size(), (unsigned)iterations, hash);
+    std::uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(hash); i++)
+    {
+        diff |= hash[i] ^ expected[i];
+    }
+    return diff == 0;
+}
+
+// Runs credential checks on a small fixed set of threads.
+//
+// A check costs tens of milliseconds of CPU by design. Doing it on the
+// session thread would let a burst of logins occupy every core; here at most
+// `threads` checks run at once and at most `queueLimit` wait, so the rest of
+// the machine keeps serving transactions. Hashing a new secret (a PIN or
+// password change) goes through the same pool. Callers get a future; when
+// the queue is full, verify() and hash() fail fast instead of piling up work.
+class CredentialVerifier
+{
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> queue;
+    size_t queueLimit;
+    bool stopping;
+    std::vector<std::thread> workers;
+
+    void work()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]
+                           { return stopping || !queue.empty(); });
+                if (queue.empty())
+                {
+                    return;
+                }
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            job();   // a packaged_task: exceptions go to the caller's future
+        }
+    }
+
+    template <typename T>
+    std::future<T> submit(std::function<T()> task)
+    {
+        auto job = std::make_shared<std::packaged_task<T()>>(std::move(task));
+        std::future<T> result = job->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= queueLimit)
+            {
+                throw std::runtime_error("Too many logins in progress, try again");
+            }
+            queue.push_back([job]
+                            { (*job)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+
+public:
+    // 0 threads = half the hardware threads, at least one
+    explicit CredentialVerifier(unsigned threads = 0, size_t maxQueued = 1024)
+        : queueLimit(maxQueued), stopping(false)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        }
+        for (unsigned i = 0; i < threads; i++)
+        {
+            workers.emplace_back(&CredentialVerifier::work, this);
+        }
+    }
+
+    CredentialVerifier(const CredentialVerifier &) = delete;
+    CredentialVerifier &operator=(const CredentialVerifier &) = delete;
+
+    // Finishes the queued checks, then joins the workers
+    ~CredentialVerifier()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto &t : workers)
+        {
+            t.join();
+        }
+    }
+
+    // Process-wide pool shared by every session
+    static CredentialVerifier &shared()
+    {
+        static CredentialVerifier instance;
+        return instance;
+    }
+
+    // `onDone` runs on the worker before the future becomes ready.
+    // Throws std::runtime_error when too many checks are already waiting.
+    std::future<bool> verify(const std::string &secret, const std::string &stored,
+                             std::function<void(bool)> onDone = nullptr)
+    {
+        return submit<bool>([secret, stored, onDone]
+                            {
+                                bool ok = verifyCredential(secret, stored);
+                                if (onDone)
+                                {
+                                    onDone(ok);
+                                }
+                                return ok;
+                            });
+    }
+
+    // Stored credential for a new secret, hashed on the pool. Throws like
+    // verify() when the queue is full.
+    std::future<std::string> hash(const std::string &secret)
+    {
+        return submit<std::string>([secret]
+                                   { return hashCredential(secret); });
+    }
+
+    size_t queued()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+};
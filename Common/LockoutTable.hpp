@@ -0,0 +1,226 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Failed-login counters per card or account, safe to use from any thread.
+//
+// Each entry is one 64-bit word: a 32-bit fingerprint of the key, an 8-bit
+// failure count and a 24-bit minute stamp of the last failure. Updates are a
+// single compare-and-swap, so there is no lock and a table of 64k entries is
+// 512 KiB. A key is locked after `maxFailures` failures until `lockMinutes`
+// have passed since the last one; after that its entry is stale and may be
+// reused by another key.
+//
+// Callers count an attempt with beginAttempt() before checking the secret
+// and clear it with recordSuccess() if it was right, so checks still in
+// flight count against the limit too. Keys probe a short run of slots; when
+// all are busy with live entries, the one whose last failure is oldest is
+// taken over unless it is locked. If every one is locked the new key cannot
+// be tracked and is treated as locked: the table fails closed.
+//
+// Two keys with the same fingerprint and home slot share a counter, which
+// can only lock a card early, never let one in.
+class LockoutTable
+{
+private:
+    static const int PROBES = 8;
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+    size_t mask;
+    unsigned maxFailures;
+    unsigned lockMinutes;
+    time_t epoch;
+
+    static std::uint64_t pack(std::uint32_t fingerprint, unsigned failures, std::uint32_t minute)
+    {
+        return (std::uint64_t)fingerprint << 32 | (std::uint64_t)(failures & 0xff) << 24 | (minute & 0xffffff);
+    }
+    static std::uint32_t fingerprintOf(std::uint64_t entry) { return (std::uint32_t)(entry >> 32); }
+    static unsigned failuresOf(std::uint64_t entry) { return (unsigned)(entry >> 24) & 0xff; }
+    static std::uint32_t minuteOf(std::uint64_t entry) { return (std::uint32_t)entry & 0xffffff; }
+
+    std::uint32_t minute(time_t now) const
+    {
+        return now > epoch ? (std::uint32_t)((now - epoch) / 60) & 0xffffff : 0;
+    }
+
+    bool expired(std::uint64_t entry, std::uint32_t nowMinute) const
+    {
+        return entry == 0 || failuresOf(entry) == 0 || nowMinute >= minuteOf(entry) + lockMinutes;
+    }
+
+    void locate(const std::string &key, size_t &home, std::uint32_t &fingerprint) const
+    {
+        std::uint64_t h = std::hash<std::string>()(key) * 0x9e3779b97f4a7c15ULL;
+        home = (size_t)(h >> 20) & mask;
+        fingerprint = (std::uint32_t)(h >> 32) | 1;   // never 0, so 0 means empty
+    }
+
+    // Adds one failure to `key` and returns its new count, or -1, changing
+    // nothing, if it cannot be tracked or `refuseLocked` is set and the key
+    // is already locked
+    int bump(const std::string &key, time_t now, bool refuseLocked)
+    {
+        size_t home;
+        std::uint32_t fingerprint;
+        locate(key, home, fingerprint);
+        std::uint32_t nowMinute = minute(now);
+
+        for (;;)
+        {
+            // The key's own slot, else the first stale one, else the live
+            // unlocked one with the oldest failure
+            long own = -1, stale = -1, oldest = -1;
+            std::uint64_t ownEntry = 0, staleEntry = 0, oldestEntry = 0;
+            for (int i = 0; i < PROBES; i++)
+            {
+                size_t slot = (home + i) & mask;
+                std::uint64_t entry = slots[slot].load(std::memory_order_acquire);
+                if (fingerprintOf(entry) == fingerprint)
+                {
+                    own = (long)slot;
+                    ownEntry = entry;
+                    break;
+                }
+                if (expired(entry, nowMinute))
+                {
+                    if (stale < 0)
+                    {
+                        stale = (long)slot;
+                        staleEntry = entry;
+                    }
+                }
+                else if (failuresOf(entry) < maxFailures && (oldest < 0 || minuteOf(entry) < minuteOf(oldestEntry)))
+                {
+                    oldest = (long)slot;
+                    oldestEntry = entry;
+                }
+            }
+
+            long target = own >= 0 ? own : stale >= 0 ? stale : oldest;
+            std::uint64_t seen = own >= 0 ? ownEntry : stale >= 0 ? staleEntry : oldestEntry;
+            if (target < 0)
+            {
+                return -1;
+            }
+
+            unsigned failures = own >= 0 && !expired(seen, nowMinute) ? failuresOf(seen) : 0;
+            if (refuseLocked && failures >= maxFailures)
+            {
+                return -1;
+            }
+            failures = failures < 255 ? failures + 1 : failures;
+            if (slots[target].compare_exchange_weak(seen, pack(fingerprint, failures, nowMinute),
+                                                    std::memory_order_acq_rel))
+            {
+                return (int)failures;
+            }
+        }
+    }
+
+    // Slot currently holding `key`, or -1
+    long find(const std::string &key, std::uint64_t &entry) const
+    {
+        size_t home;
+        std::uint32_t fingerprint;
+        locate(key, home, fingerprint);
+        for (int i = 0; i < PROBES; i++)
+        {
+            size_t slot = (home + i) & mask;
+            entry = slots[slot].load(std::memory_order_acquire);
+            if (fingerprintOf(entry) == fingerprint)
+            {
+                return (long)slot;
+            }
+        }
+        return -1;
+    }
+
+public:
+    // capacity is rounded up to a power of two
+    explicit LockoutTable(size_t capacity = 1 << 16, unsigned failuresAllowed = 3, unsigned lockoutMinutes = 15)
+        : maxFailures(failuresAllowed), lockMinutes(lockoutMinutes), epoch(time(nullptr))
+    {
+        size_t size = 16;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots.reset(new std::atomic<std::uint64_t>[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            slots[i].store(0, std::memory_order_relaxed);
+        }
+        mask = size - 1;
+    }
+
+    // Process-wide table for cards, shared by every ATM
+    static LockoutTable &shared()
+    {
+        static LockoutTable instance;
+        return instance;
+    }
+
+    bool isLocked(const std::string &key, time_t now) const
+    {
+        std::uint64_t entry;
+        return find(key, entry) >= 0 && !expired(entry, minute(now)) && failuresOf(entry) >= maxFailures;
+    }
+
+    // Counts an attempt as a failure before its secret is checked. Returns
+    // false, counting nothing, if the key is locked or cannot be tracked; the
+    // caller must then refuse the attempt without checking it.
+    bool beginAttempt(const std::string &key, time_t now)
+    {
+        return bump(key, now, true) >= 0;
+    }
+
+    // Takes back an attempt counted by beginAttempt() that was never checked
+    // (e.g. the verifier queue was full)
+    void cancelAttempt(const std::string &key)
+    {
+        size_t home;
+        std::uint32_t fingerprint;
+        locate(key, home, fingerprint);
+        std::uint64_t entry;
+        long slot = find(key, entry);
+        while (slot >= 0 && fingerprintOf(entry) == fingerprint && failuresOf(entry) != 0)
+        {
+            if (slots[slot].compare_exchange_weak(entry, pack(fingerprint, failuresOf(entry) - 1, minuteOf(entry)),
+                                                  std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+    }
+
+    // Counts a failed attempt that was not begun with beginAttempt(); returns
+    // true if the key is now locked, or could not be tracked
+    bool recordFailure(const std::string &key, time_t now)
+    {
+        int failures = bump(key, now, false);
+        return failures < 0 || (unsigned)failures >= maxFailures;
+    }
+
+    // Clears the count after a successful login
+    void recordSuccess(const std::string &key)
+    {
+        size_t home;
+        std::uint32_t fingerprint;
+        locate(key, home, fingerprint);
+        std::uint64_t entry;
+        long slot = find(key, entry);
+        while (slot >= 0 && fingerprintOf(entry) == fingerprint && failuresOf(entry) != 0)
+        {
+            if (slots[slot].compare_exchange_weak(entry, pack(fingerprint, 0, minuteOf(entry)),
+                                                  std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+    }
+};
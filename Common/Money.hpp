@@ -0,0 +1,128 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <string>
+
+// Money is an exact count of minor units (cents). Arithmetic on it is plain
+// integer arithmetic, so balances never drift and totals compare exactly.
+// Only user input and display go through the decimal helpers below.
+typedef std::int64_t Money;
+
+const Money MINOR_PER_UNIT = 100;
+
+// Whole units to money, for constants: moneyUnits(5000) is 5000.00
+constexpr Money moneyUnits(std::int64_t units)
+{
+    return units * MINOR_PER_UNIT;
+}
+
+// Rounds a computed amount (e.g. interest) to the nearest minor unit
+inline Money moneyFromDouble(double units)
+{
+    return static_cast<Money>(std::llround(units * MINOR_PER_UNIT));
+}
+
+inline double moneyToDouble(Money value)
+{
+    return static_cast<double>(value) / MINOR_PER_UNIT;
+}
+
+// Parses "12", "12.5", "-0.07", "+3.10". Rejects anything else, including
+// more than two decimals or values that do not fit.
+inline bool parseMoney(const char *begin, const char *end, Money &out)
+{
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    const std::int64_t maxUnits = (INT64_MAX - (MINOR_PER_UNIT - 1)) / MINOR_PER_UNIT;
+    std::int64_t units = 0;
+    const char *digits = p;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        int digit = *p++ - '0';
+        if (units > (maxUnits - digit) / 10)
+        {
+            return false;
+        }
+        units = units * 10 + digit;
+    }
+    bool haveDigits = p > digits;
+    std::int64_t minor = 0;
+    if (p < end && *p == '.')
+    {
+        p++;
+        int decimals = 0;
+        while (p < end && *p >= '0' && *p <= '9' && decimals < 2)
+        {
+            minor = minor * 10 + (*p++ - '0');
+            decimals++;
+        }
+        haveDigits = haveDigits || decimals > 0;
+        for (; decimals < 2; decimals++)
+        {
+            minor *= 10;
+        }
+    }
+    if (!haveDigits || p != end)
+    {
+        return false;
+    }
+    Money value = units * MINOR_PER_UNIT + minor;
+    out = negative ? -value : value;
+    return true;
+}
+
+inline bool parseMoney(const std::string &text, Money &out)
+{
+    return parseMoney(text.data(), text.data() + text.size(), out);
+}
+
+// Writes "-12.05" style text into buf (at least 24 chars); returns the end
+inline char *formatMoney(Money value, char *buf)
+{
+    char digits[24];
+    int n = 0;
+    std::uint64_t magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    do
+    {
+        digits[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0 || n < 3);
+
+    char *p = buf;
+    if (value < 0)
+    {
+        *p++ = '-';
+    }
+    while (n > 2)
+    {
+        *p++ = digits[--n];
+    }
+    *p++ = '.';
+    *p++ = digits[1];
+    *p++ = digits[0];
+    return p;
+}
+
+inline std::string formatMoney(Money value)
+{
+    char buf[24];
+    return std::string(buf, formatMoney(value, buf));
+}
+
+// Reads one whitespace-delimited amount; sets failbit if it is not money
+inline std::istream &readMoney(std::istream &in, Money &out)
+{
+    std::string token;
+    if (in >> token && !parseMoney(token, out))
+    {
+        in.setstate(std::ios::failbit);
+    }
+    return in;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// SHA-256 (FIPS 180-4), HMAC-SHA-256 and PBKDF2-HMAC-SHA-256 (RFC 8018).
+class Sha256
+{
+public:
+    static const size_t DIGEST_SIZE = 32;
+    static const size_t BLOCK_SIZE = 64;
+
+private:
+    std::uint32_t state[8];
+    std::uint8_t block[BLOCK_SIZE];
+    size_t used;
+    std::uint64_t length;
+
+    static std::uint32_t rotr(std::uint32_t x, int n)
+    {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    void compress(const std::uint8_t *data)
+    {
+        static const std::uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+        {
+            w[i] = (std::uint32_t)data[i * 4] << 24 | (std::uint32_t)data[i * 4 + 1] << 16 |
+                   (std::uint32_t)data[i * 4 + 2] << 8 | (std::uint32_t)data[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; i++)
+        {
+            std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++)
+        {
+            std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+
+public:
+    Sha256() { reset(); }
+
+    void reset()
+    {
+        static const std::uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        std::memcpy(state, initial, sizeof(state));
+        used = 0;
+        length = 0;
+    }
+
+    void update(const void *data, size_t size)
+    {
+        const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+        length += size;
+        while (size > 0)
+        {
+            size_t n = BLOCK_SIZE - used < size ? BLOCK_SIZE - used : size;
+            std::memcpy(block + used, p, n);
+            used += n;
+            p += n;
+            size -= n;
+            if (used == BLOCK_SIZE)
+            {
+                compress(block);
+                used = 0;
+            }
+        }
+    }
+
+    void finish(std::uint8_t digest[DIGEST_SIZE])
+    {
+        std::uint64_t bits = length * 8;
+        block[used++] = 0x80;
+        if (used > BLOCK_SIZE - 8)
+        {
+            std::memset(block + used, 0, BLOCK_SIZE - used);
+            compress(block);
+            used = 0;
+        }
+        std::memset(block + used, 0, BLOCK_SIZE - 8 - used);
+        for (int i = 0; i < 8; i++)
+        {
+            block[BLOCK_SIZE - 8 + i] = (std::uint8_t)(bits >> (56 - 8 * i));
+        }
+        compress(block);
+        used = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            digest[i * 4] = (std::uint8_t)(state[i] >> 24);
+            digest[i * 4 + 1] = (std::uint8_t)(state[i] >> 16);
+            digest[i * 4 + 2] = (std::uint8_t)(state[i] >> 8);
+            digest[i * 4 + 3] = (std::uint8_t)state[i];
+        }
+    }
+};
+
+// HMAC keyed once; each mac() restarts from the precomputed inner and outer
+// states, which halves the work per PBKDF2 iteration.
+class HmacSha256
+{
+private:
+    Sha256 inner;
+    Sha256 outer;
+
+public:
+    HmacSha256(const void *key, size_t keySize)
+    {
+        std::uint8_t pad[Sha256::BLOCK_SIZE] = {};
+        if (keySize > Sha256::BLOCK_SIZE)
+        {
+            Sha256 h;
+            h.update(key, keySize);
+            h.finish(pad);
+        }
+        else
+        {
+            std::memcpy(pad, key, keySize);
+        }
+        for (size_t i = 0; i < Sha256::BLOCK_SIZE; i++)
+        {
+            pad[i] ^= 0x36;
+        }
+        inner.update(pad, Sha256::BLOCK_SIZE);
+        for (size_t i = 0; i < Sha256::BLOCK_SIZE; i++)
+        {
+            pad[i] ^= 0x36 ^ 0x5c;
+        }
+        outer.update(pad, Sha256::BLOCK_SIZE);
+    }
+
+    void mac(const void *data, size_t size, std::uint8_t out[Sha256::DIGEST_SIZE]) const
+    {
+        Sha256 h = inner;
+        h.update(data, size);
+        h.finish(out);
+        h = outer;
+        h.update(out, Sha256::DIGEST_SIZE);
+        h.finish(out);
+    }
+};
+
+// Derives one 32-byte key (a single PBKDF2 block). Salts up to 64 bytes.
+inline void pbkdf2Sha256(const std::string &secret, const std::uint8_t *salt, size_t saltSize,
+                         unsigned iterations, std::uint8_t out[Sha256::DIGEST_SIZE])
+{
+    HmacSha256 hmac(secret.data(), secret.size());
+    std::uint8_t first[64 + 4];
+    std::uint8_t u[Sha256::DIGEST_SIZE];
+    size_t n = saltSize < 64 ? saltSize : 64;
+    std::memcpy(first, salt, n);
+    first[n] = 0;
+    first[n + 1] = 0;
+    first[n + 2] = 0;
+    first[n + 3] = 1;
+    hmac.mac(first, n + 4, u);
+    std::memcpy(out, u, sizeof(u));
+    for (unsigned i = 1; i < iterations; i++)
+    {
+        hmac.mac(u, sizeof(u), u);
+        for (size_t j = 0; j < sizeof(u); j++)
+        {
+            out[j] ^= u[j];
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+#include "Money.hpp"
+
+// Bucketed sliding window over the last Buckets * BucketSeconds seconds.
+//
+// Keeps an event count and an amount total per bucket in a ring, plus running
+// totals, so recording an event or checking a limit is O(1) and the memory per
+// window is fixed. Expired buckets are cleared lazily on the next access. The
+// ring holds the current bucket plus Buckets whole ones before it, so an event
+// is forgotten between Buckets and Buckets + 1 buckets after it happened:
+// never early, at most one bucket late.
+template <unsigned Buckets, unsigned BucketSeconds>
+class SlidingWindow
+{
+private:
+    static const unsigned Slots = Buckets + 1;
+
+    std::uint32_t counts[Slots];
+    Money amounts[Slots];
+    std::int64_t head;        // absolute bucket index of the newest bucket
+    std::uint32_t totalCount;
+    Money totalAmount;
+
+    void advance(time_t now)
+    {
+        std::int64_t bucket = static_cast<std::int64_t>(now) / BucketSeconds;
+        if (bucket <= head)
+        {
+            return;
+        }
+        if (bucket - head >= Slots)
+        {
+            clear();
+        }
+        else
+        {
+            for (std::int64_t b = head + 1; b <= bucket; ++b)
+            {
+                unsigned slot = static_cast<unsigned>(b % Slots);
+                totalCount -= counts[slot];
+                totalAmount -= amounts[slot];
+                counts[slot] = 0;
+                amounts[slot] = 0;
+            }
+        }
+        head = bucket;
+    }
+
+public:
+    SlidingWindow() : head(0) { clear(); }
+
+    void clear()
+    {
+        for (unsigned i = 0; i < Slots; ++i)
+        {
+            counts[i] = 0;
+            amounts[i] = 0;
+        }
+        totalCount = 0;
+        totalAmount = 0;
+    }
+
+    // True if one more event of this amount stays within both limits.
+    // A negative limit means "no limit".
+    bool allows(time_t now, Money amount, long long maxCount, Money maxAmount)
+    {
+        advance(now);
+        if (maxCount >= 0 && totalCount + 1 > maxCount)
+        {
+            return false;
+        }
+        if (maxAmount >= 0 && totalAmount + amount > maxAmount)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    void record(time_t now, Money amount)
+    {
+        advance(now);
+        unsigned slot = static_cast<unsigned>(head % Slots);
+        counts[slot]++;
+        amounts[slot] += amount;
+        totalCount++;
+        totalAmount += amount;
+    }
+
+    std::uint32_t count(time_t now)
+    {
+        advance(now);
+        return totalCount;
+    }
+
+    Money total(time_t now)
+    {
+        advance(now);
+        return totalAmount;
+    }
+};
@@ -0,0 +1,317 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_HAVE_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define TRACE_HAVE_TSC 1
+#endif
+
+// Trace points. Build with -DENABLE_TRACING to record them; otherwise they
+// expand to nothing and their arguments are not evaluated.
+//   TRACE_SCOPE(name, arg)   - one event covering the rest of the block
+//   TRACE_INSTANT(name, arg) - a zero-length event
+// `name` must be a string literal; `arg` is any int (account number, menu
+// choice, ...).
+#ifdef ENABLE_TRACING
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name, arg) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, (std::int32_t)(arg))
+#define TRACE_INSTANT(name, arg) Trace::record(name, Trace::now(), 0, (std::int32_t)(arg))
+#else
+#define TRACE_SCOPE(name, arg) ((void)0)
+#define TRACE_INSTANT(name, arg) ((void)0)
+#endif
+
+// One recorded event; 32 bytes so two share a cache line
+struct TraceEvent
+{
+    std::uint64_t start;      // ticks
+    std::uint64_t duration;   // ticks, 0 for instants
+    const char *name;
+    std::uint32_t thread;
+    std::int32_t arg;
+};
+
+// Per-thread event recorder.
+//
+// Each thread appends to its own ring, so recording is a timestamp read and
+// a 32-byte store with no locks or shared cache lines; when a ring is full
+// the oldest events are overwritten. flush() copies every ring from another
+// thread and drops any event the owner may have been overwriting during the
+// copy. Timestamps are raw TSC ticks where available and are converted to
+// nanoseconds at flush time.
+//
+// Flushed files are "TRC1", a u32 name count with u16-length names, a u64
+// event count and then {u64 startNs, u64 durationNs, u32 name, u32 thread,
+// i32 arg} per event. toChromeJson() turns one into a trace for
+// chrome://tracing or Perfetto.
+class Trace
+{
+public:
+    static const size_t RING_SIZE = 1 << 16;   // events per thread, power of two
+
+private:
+    struct Ring
+    {
+        TraceEvent events[RING_SIZE];
+        std::atomic<std::uint64_t> head{0};
+        std::uint32_t thread = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<Ring *> rings;   // live for the whole process
+        std::uint32_t nextThread = 1;
+        std::uint64_t baseTicks = Trace::now();
+        std::chrono::steady_clock::time_point baseTime = std::chrono::steady_clock::now();
+        std::atomic<bool> flushRequested{false};
+        std::string signalPath;
+    };
+
+    static Registry &registry()
+    {
+        static Registry *instance = new Registry();   // never destroyed; threads may trace during exit
+        return *instance;
+    }
+
+    static Ring &ring()
+    {
+        static thread_local Ring *local = nullptr;
+        if (local == nullptr)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            local = new Ring();
+            local->thread = r.nextThread++;
+            r.rings.push_back(local);
+        }
+        return *local;
+    }
+
+    static void signalHandler(int)
+    {
+        registry().flushRequested.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void put(std::FILE *file, T value)
+    {
+        std::fwrite(&value, sizeof(value), 1, file);
+    }
+
+    template <typename T>
+    static bool get(std::FILE *file, T &value)
+    {
+        return std::fread(&value, sizeof(value), 1, file) == 1;
+    }
+
+public:
+    static std::uint64_t now()
+    {
+#ifdef TRACE_HAVE_TSC
+        return __rdtsc();
+#else
+        return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    static void record(const char *name, std::uint64_t start, std::uint64_t duration, std::int32_t arg)
+    {
+        Ring &r = ring();
+        std::uint64_t h = r.head.load(std::memory_order_relaxed);
+        TraceEvent &e = r.events[h & (RING_SIZE - 1)];
+        e.start = start;
+        e.duration = duration;
+        e.name = name;
+        e.thread = r.thread;
+        e.arg = arg;
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+    // Writes everything still in the rings to `path`; returns the number of
+    // events written. Safe to call while other threads keep tracing.
+    static size_t flush(const std::string &path)
+    {
+        Registry &reg = registry();
+        std::vector<TraceEvent> events;
+        {
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            for (Ring *r : reg.rings)
+            {
+                std::uint64_t end = r->head.load(std::memory_order_acquire);
+                std::uint64_t begin = end > RING_SIZE ? end - RING_SIZE : 0;
+                size_t first = events.size();
+                for (std::uint64_t i = begin; i < end; i++)
+                {
+                    events.push_back(r->events[i & (RING_SIZE - 1)]);
+                }
+                // Slots from `begin` up to the owner's next write may have
+                // been reused while we copied
+                std::uint64_t after = r->head.load(std::memory_order_acquire);
+                std::uint64_t overwritten = after + 1 > begin + RING_SIZE ? after + 1 - RING_SIZE - begin : 0;
+                overwritten = overwritten < end - begin ? overwritten : end - begin;
+                events.erase(events.begin() + first, events.begin() + first + overwritten);
+            }
+        }
+
+        // Ticks to nanoseconds since the registry was created
+        std::uint64_t ticks = now() - reg.baseTicks;
+        double nsPerTick = 1.0;
+#ifdef TRACE_HAVE_TSC
+        double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - reg.baseTime)
+                               .count();
+        nsPerTick = ticks > 0 ? elapsedNs / (double)ticks : 1.0;
+#else
+        (void)ticks;
+#endif
+
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return 0;
+        }
+        std::unordered_map<const char *, std::uint32_t> nameIds;
+        std::vector<const char *> names;
+        for (const TraceEvent &e : events)
+        {
+            if (nameIds.emplace(e.name, (std::uint32_t)names.size()).second)
+            {
+                names.push_back(e.name);
+            }
+        }
+
+        std::fwrite("TRC1", 1, 4, file);
+        put<std::uint32_t>(file, (std::uint32_t)names.size());
+        for (const char *name : names)
+        {
+            std::string s(name);
+            put<std::uint16_t>(file, (std::uint16_t)s.size());
+            std::fwrite(s.data(), 1, s.size(), file);
+        }
+        put<std::uint64_t>(file, events.size());
+        for (const TraceEvent &e : events)
+        {
+            std::int64_t since = (std::int64_t)(e.start - reg.baseTicks);
+            put<std::uint64_t>(file, since > 0 ? (std::uint64_t)(since * nsPerTick) : 0);
+            put<std::uint64_t>(file, (std::uint64_t)(e.duration * nsPerTick));
+            put<std::uint32_t>(file, nameIds[e.name]);
+            put<std::uint32_t>(file, e.thread);
+            put<std::int32_t>(file, e.arg);
+        }
+        std::fclose(file);
+        return events.size();
+    }
+
+    // Converts a flushed file to Chrome trace-event JSON
+    static bool toChromeJson(const std::string &tracePath, const std::string &jsonPath)
+    {
+        std::FILE *in = std::fopen(tracePath.c_str(), "rb");
+        if (in == nullptr)
+        {
+            return false;
+        }
+        char magic[4];
+        std::uint32_t nameCount = 0;
+        bool ok = std::fread(magic, 1, 4, in) == 4 && std::string(magic, 4) == "TRC1" && get(in, nameCount);
+        std::vector<std::string> names;
+        for (std::uint32_t i = 0; ok && i < nameCount; i++)
+        {
+            std::uint16_t length;
+            ok = get(in, length);
+            std::string name(ok ? length : 0, '\0');
+            ok = ok && std::fread(&name[0], 1, length, in) == length;
+            names.push_back(name);
+        }
+        std::uint64_t count = 0;
+        ok = ok && get(in, count);
+        std::FILE *out = ok ? std::fopen(jsonPath.c_str(), "w") : nullptr;
+        if (out == nullptr)
+        {
+            std::fclose(in);
+            return false;
+        }
+
+        std::fputs("{\"traceEvents\":[\n", out);
+        for (std::uint64_t i = 0; i < count; i++)
+        {
+            std::uint64_t startNs, durationNs;
+            std::uint32_t name, thread;
+            std::int32_t arg;
+            if (!get(in, startNs) || !get(in, durationNs) || !get(in, name) || !get(in, thread) || !get(in, arg) ||
+                name >= names.size())
+            {
+                break;
+            }
+            std::fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,", i == 0 ? "" : ",\n",
+                         names[name].c_str(), durationNs > 0 ? "X" : "i", startNs / 1000.0);
+            if (durationNs > 0)
+            {
+                std::fprintf(out, "\"dur\":%.3f,", durationNs / 1000.0);
+            }
+            else
+            {
+                std::fputs("\"s\":\"t\",", out);
+            }
+            std::fprintf(out, "\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%d}}", thread, arg);
+        }
+        std::fputs("\n]}\n", out);
+        std::fclose(out);
+        std::fclose(in);
+        return true;
+    }
+
+#ifdef SIGUSR1
+    // Flushes to `path` whenever the process gets SIGUSR1. The handler only
+    // sets a flag; a background thread does the writing. Call once.
+    static void flushOnSignal(const std::string &path)
+    {
+        Registry &reg = registry();
+        reg.signalPath = path;
+        std::signal(SIGUSR1, signalHandler);
+        std::thread watcher([&reg]()
+        {
+            for (;;)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (reg.flushRequested.exchange(false))
+                {
+                    flush(reg.signalPath);
+                }
+            }
+        });
+        watcher.detach();
+    }
+#endif
+};
+
+// Records one event spanning its own lifetime
+class TraceScope
+{
+private:
+    const char *name;
+    std::uint64_t start;
+    std::int32_t arg;
+
+public:
+    TraceScope(const char *eventName, std::int32_t eventArg) : name(eventName), start(Trace::now()), arg(eventArg) {}
+    ~TraceScope() { Trace::record(name, start, Trace::now() - start, arg); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ctime>
+#include "../Common/Money.hpp"
+
+// Account types
+enum AccountType { SAVINGS = 1, CURRENT };
+
+// Transaction structure
+struct Transaction {
+    int id;
+    std::string type;
+    Money amount;        // minor units, always positive
+    time_t timestamp;
+    int fromAccount;
+    int toAccount;
+    std::string description;
+};
+
+// Account structure
+struct Account {
+    int accountNumber;
+    std::string name;
+    AccountType type;
+    Money balance;       // minor units
+    int32_t interestCarry = 0;   // unpaid interest below one minor unit, in millionths of one
+    int32_t lastAccrualDate = 0; // business day of the last end-of-day run applied, as YYYYMMDD
+    std::string password;
+    time_t creationDate;
+    std::vector<Transaction> transactions;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include "Account.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Debit rules per account type, fixed at compile time.
+//
+// Each policy is a plain struct of constants. withdraw/transfer dispatch on
+// the account type once, then run debitFor<Policy>, which the compiler
+// specializes per policy: zero fees and limits fold away and the checks are
+// a couple of compares. The velocity limits are the defaults VelocityLimiter
+// starts from (a negative one means no limit). To add an account type, add
+// its enum value, write a policy with the same members, and list it in
+// AccountPolicies.
+struct SavingsPolicy {
+    static constexpr AccountType type = SAVINGS;
+    static constexpr Money overdraftLimit = 0;                  // how far below minimumBalance a debit may go
+    static constexpr Money minimumBalance = 0;
+    static constexpr Money maxDebit = moneyUnits(5000);        // per withdrawal or transfer
+    static constexpr Money withdrawalFee = 0;
+    static constexpr Money transferFee = 0;
+    static constexpr long long maxWithdrawalsPerDay = 5;
+    static constexpr Money maxWithdrawalAmountPerDay = moneyUnits(2000);
+    static constexpr long long maxTransfersPerMinute = 5;
+};
+
+struct CurrentPolicy {
+    static constexpr AccountType type = CURRENT;
+    static constexpr Money overdraftLimit = moneyUnits(500);
+    static constexpr Money minimumBalance = 0;
+    static constexpr Money maxDebit = moneyUnits(50000);
+    static constexpr Money withdrawalFee = 0;
+    static constexpr Money transferFee = 0;
+    static constexpr long long maxWithdrawalsPerDay = 20;
+    static constexpr Money maxWithdrawalAmountPerDay = moneyUnits(10000);
+    static constexpr long long maxTransfersPerMinute = 30;
+};
+
+template <typename... Policies>
+struct PolicyList {};
+
+using AccountPolicies = PolicyList<SavingsPolicy, CurrentPolicy>;
+
+// Position of Policy in a PolicyList, for keeping per-policy state in an array
+template <typename Policy, typename List>
+struct PolicyIndex;
+
+template <typename Policy, typename... Rest>
+struct PolicyIndex<Policy, PolicyList<Policy, Rest...>> : std::integral_constant<size_t, 0> {};
+
+template <typename Policy, typename First, typename... Rest>
+struct PolicyIndex<Policy, PolicyList<First, Rest...>>
+    : std::integral_constant<size_t, 1 + PolicyIndex<Policy, PolicyList<Rest...>>::value> {};
+
+template <typename List>
+struct PolicyCount;
+
+template <typename... Policies>
+struct PolicyCount<PolicyList<Policies...>> : std::integral_constant<size_t, sizeof...(Policies)> {};
+
+// What f returns across all policies of a list; fails to compile if the
+// policies' results have no common type.
+template <typename F, typename List>
+struct PolicyResult;
+
+template <typename F, typename... Policies>
+struct PolicyResult<F, PolicyList<Policies...>> {
+    using type = std::common_type_t<decltype(std::declval<F&>()(Policies()))...>;
+};
+
+// Calls f(Policy()) for the policy matching `type`. A type with no listed
+// policy (e.g. an out-of-range value cast from input) gets no policy at all:
+// the result is value-initialized, which for the debit helpers below is 0,
+// i.e. refused.
+template <typename R, typename F>
+R withAccountPolicy(AccountType, F&&, PolicyList<>) {
+    return R();
+}
+
+template <typename R, typename F, typename First, typename... Rest>
+R withAccountPolicy(AccountType type, F&& f, PolicyList<First, Rest...>) {
+    if (type == First::type) {
+        return f(First());
+    }
+    return withAccountPolicy<R>(type, std::forward<F>(f), PolicyList<Rest...>());
+}
+
+template <typename F>
+auto withAccountPolicy(AccountType type, F&& f) {
+    using R = typename PolicyResult<F, AccountPolicies>::type;
+    return withAccountPolicy<R>(type, std::forward<F>(f), AccountPolicies());
+}
+
+// Total to take from `balance` to debit `amount` plus `fee`, or 0 if the
+// policy refuses it. The amount is bounded before anything is added to it,
+// and the balance is compared against floor + total (both small) rather
+// than having total subtracted from it, so no step can overflow.
+template <typename Policy>
+inline Money debitFor(Money balance, Money amount, Money fee) {
+    if (amount <= 0 || amount > Policy::maxDebit) {
+        return 0;
+    }
+    Money total = amount + fee;
+    Money floor = Policy::minimumBalance - Policy::overdraftLimit;
+    return balance >= floor + total ? total : 0;
+}
+
+inline Money withdrawalDebit(const Account& account, Money amount) {
+    return withAccountPolicy(account.type, [&](auto policy) {
+        using Policy = decltype(policy);
+        return debitFor<Policy>(account.balance, amount, Policy::withdrawalFee);
+    });
+}
+
+inline Money transferDebit(const Account& account, Money amount) {
+    return withAccountPolicy(account.type, [&](auto policy) {
+        using Policy = decltype(policy);
+        return debitFor<Policy>(account.balance, amount, Policy::transferFee);
+    });
+}
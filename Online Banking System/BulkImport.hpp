@@ -0,0 +1,440 @@
+#pragma once
+#include "Account.hpp"
+#include "../Common/Credentials.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct ImportResult {
+    size_t imported = 0;
+    size_t transactions = 0;    // history rows imported, plus OPENING ones
+    size_t rejected = 0;        // malformed rows, skipped
+    size_t hashed = 0;          // plaintext passwords, hashed during the import
+    int firstAccountNumber = 0;
+    int lastAccountNumber = 0;
+};
+
+// Read-only view of a whole file. Memory-mapped where available, read into
+// memory otherwise.
+class MappedFile {
+private:
+    const char* data_;
+    size_t size_;
+    std::string fallback;
+#ifndef _WIN32
+    void* mapping;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+#ifndef _WIN32
+        mapping = nullptr;
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_ = (size_t)st.st_size;
+            mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map " + path);
+            }
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapping);
+        }
+        close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data_ = fallback.data();
+        size_ = fallback.size();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping != nullptr) {
+            munmap(mapping, size_);
+        }
+#endif
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+// Bulk account loader for migrations.
+//
+// Input is CSV, one account per row, each followed by its history rows:
+//   name,type,password,opening_balance
+//   ,type,amount,timestamp,description
+// An account's `type` is SAVINGS/CURRENT (or 1/2); a history row starts with
+// an empty field and has the type DEPOSIT, WITHDRAWAL, INTEREST or FEE.
+// Transfers cannot be paired with a counterparty across the migration, so
+// they must be given as deposits and withdrawals. Fields may be quoted as in
+// the ledger export, and quoted fields may span lines. A first line starting
+// with "name," is taken as a header.
+//
+// A positive opening balance is recorded as an OPENING transaction and the
+// history is applied on top of it, so the imported balance always agrees
+// with the imported history. A history row that does not parse, or follows
+// a rejected account, is counted as rejected and skipped. The password must
+// be a stored hash (see Credentials.hpp) or plaintext; plaintext ones are
+// hashed during the import, spread over all the threads since each costs
+// tens of milliseconds.
+//
+// The file is mapped and cut into one chunk per thread at the start of an
+// account row, outside any quoted field; where each cut falls is found from
+// quote counts taken in parallel. Each thread parses its chunk into its own
+// batch; chunks then get consecutive account number ranges in file order,
+// and the batches are moved into storage that was grown once for the whole
+// import. load() does the parsing and hashing and append() only the
+// numbering and moving, so a caller that holds a lock while adding the
+// accounts need only hold it for append().
+class BulkAccountImporter {
+private:
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<Account> accounts;
+        size_t transactions = 0;
+        size_t rejected = 0;
+        std::vector<size_t> plaintext;   // accounts whose password needs hashing
+    };
+
+    // Start of the row after the one at `p`. `quoted` says whether `p` is
+    // inside a quoted field; line breaks inside one do not end the row.
+    static const char* nextRow(const char* p, const char* end, bool quoted) {
+        for (; p < end; p++) {
+            if (*p == '"') {
+                quoted = !quoted;
+            } else if (*p == '\n' && !quoted) {
+                return p + 1;
+            }
+        }
+        return end;
+    }
+
+    // Splits one line into fields, undoing CSV quoting
+    static void splitLine(const char* p, const char* end, std::vector<std::string>& fields) {
+        fields.clear();
+        for (;;) {
+            std::string field;
+            if (p < end && *p == '"') {
+                p++;
+                while (p < end) {
+                    if (*p == '"') {
+                        if (p + 1 < end && p[1] == '"') {
+                            field += '"';
+                            p += 2;
+                            continue;
+                        }
+                        p++;
+                        break;
+                    }
+                    field += *p++;
+                }
+                while (p < end && *p != ',') {
+                    p++;
+                }
+            } else {
+                const char* start = p;
+                while (p < end && *p != ',') {
+                    p++;
+                }
+                field.assign(start, p);
+            }
+            fields.push_back(std::move(field));
+            if (p >= end) {
+                return;
+            }
+            p++;   // skip ','
+        }
+    }
+
+    static bool parseType(const std::string& text, AccountType& type) {
+        if (text == "SAVINGS" || text == "Savings" || text == "savings" || text == "1") {
+            type = SAVINGS;
+            return true;
+        }
+        if (text == "CURRENT" || text == "Current" || text == "current" || text == "2") {
+            type = CURRENT;
+            return true;
+        }
+        return false;
+    }
+
+    // Sign of a history row's amount in the balance; 0 if the type is not
+    // importable
+    static int historySign(const std::string& type) {
+        if (type == "DEPOSIT" || type == "INTEREST") {
+            return 1;
+        }
+        if (type == "WITHDRAWAL" || type == "FEE") {
+            return -1;
+        }
+        return 0;
+    }
+
+    // Appends one history row to `account`. Its own account number is left
+    // as 0 and filled in once numbers are assigned.
+    static bool addHistory(Account& account, std::vector<std::string>& fields) {
+        int sign = historySign(fields[1]);
+        Money amount;
+        char* numberEnd = nullptr;
+        long long timestamp = std::strtoll(fields[3].c_str(), &numberEnd, 10);
+        if (sign == 0 || !parseMoney(fields[2], amount) || amount <= 0 ||
+            fields[3].empty() || *numberEnd != '\0') {
+            return false;
+        }
+
+        Transaction t;
+        t.id = (int)account.transactions.size() + 1;
+        t.type = std::move(fields[1]);
+        t.amount = amount;
+        t.timestamp = (time_t)timestamp;
+        t.fromAccount = sign < 0 ? 0 : -1;
+        t.toAccount = sign < 0 ? -1 : 0;
+        t.description = std::move(fields[4]);
+        if (t.timestamp < account.creationDate) {
+            // The account existed before its first migrated movement
+            account.creationDate = t.timestamp;
+            if (!account.transactions.empty()) {
+                account.transactions[0].timestamp = t.timestamp;
+            }
+        }
+        account.balance += sign * amount;
+        account.transactions.push_back(std::move(t));
+        return true;
+    }
+
+    static void parseChunk(Chunk& chunk, time_t now) {
+        std::vector<std::string> fields;
+        Account* current = nullptr;   // account the next history row belongs to
+        const char* p = chunk.begin;
+        while (p < chunk.end) {
+            const char* next = nextRow(p, chunk.end, false);
+            const char* lineEnd = next > p && next[-1] == '\n' ? next - 1 : next;
+            if (lineEnd > p && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+
+            if (lineEnd == p) {
+                p = next;
+                continue;
+            }
+
+            splitLine(p, lineEnd, fields);
+            if (fields[0].empty()) {
+                if (current != nullptr && fields.size() == 5 && addHistory(*current, fields)) {
+                    chunk.transactions++;
+                } else {
+                    chunk.rejected++;
+                }
+                p = next;
+                continue;
+            }
+
+            current = nullptr;
+            AccountType type;
+            Money balance = 0;
+            bool ok = fields.size() == 4 && !fields[0].empty() && parseType(fields[1], type);
+            if (ok && !fields[3].empty()) {
+                ok = parseMoney(fields[3], balance) && balance >= 0;
+            }
+
+            if (!ok) {
+                chunk.rejected++;
+                p = next;
+                continue;
+            }
+            if (!isHashedCredential(fields[2])) {
+                chunk.plaintext.push_back(chunk.accounts.size());
+            }
+
+            chunk.accounts.emplace_back();
+            Account& account = chunk.accounts.back();
+            account.accountNumber = 0;   // assigned once all chunks are counted
+            account.name = std::move(fields[0]);
+            account.type = type;
+            account.balance = balance;
+            account.password = std::move(fields[2]);
+            account.creationDate = now;
+            if (balance > 0) {
+                Transaction t;
+                t.id = 1;
+                t.type = "OPENING";
+                t.amount = balance;
+                t.timestamp = now;
+                t.fromAccount = -1;
+                t.toAccount = 0;
+                t.description = "Opening balance";
+                account.transactions.push_back(std::move(t));
+                chunk.transactions++;
+            }
+            current = &account;
+            p = next;
+        }
+    }
+
+    template <typename F>
+    static void parallelFor(size_t count, F f) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; i++) {
+            workers.emplace_back(f, i);
+        }
+        if (count > 0) {
+            f(0);
+        }
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+public:
+    // Parsed and hashed accounts, not yet numbered
+    class Batch {
+    private:
+        friend class BulkAccountImporter;
+        std::vector<std::vector<Account>> parts;   // one per chunk, in file order
+        ImportResult counts;
+    };
+
+    // Reads the file and hashes its plaintext passwords
+    static Batch load(const std::string& path, unsigned threads = 0) {
+        MappedFile file(path);
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+
+        const char header[] = "name,";
+        if (file.size() >= sizeof(header) - 1 && std::equal(header, header + sizeof(header) - 1, begin)) {
+            begin = std::find(begin, end, '\n');
+            begin = begin < end ? begin + 1 : end;
+        }
+
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t minChunk = 1 << 16;
+        size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads, (end - begin) / minChunk + 1));
+
+        // Quotes before each even split point tell whether it falls inside
+        // a quoted field; each cut then moves on to the next account row.
+        std::vector<const char*> splits(chunkCount + 1);
+        std::vector<size_t> quotes(chunkCount);
+        for (size_t i = 0; i <= chunkCount; i++) {
+            splits[i] = begin + (end - begin) * i / chunkCount;
+        }
+        parallelFor(chunkCount, [&](size_t i) { quotes[i] = std::count(splits[i], splits[i + 1], '"'); });
+
+        std::vector<Chunk> chunks(chunkCount);
+        const char* p = begin;
+        size_t quotesBefore = 0;
+        for (size_t i = 0; i < chunkCount; i++) {
+            quotesBefore += quotes[i];
+            const char* cut = end;
+            if (i + 1 < chunkCount) {
+                cut = splits[i + 1] < p ? p : nextRow(splits[i + 1], end, quotesBefore % 2 == 1);
+                while (cut < end && *cut == ',') {
+                    cut = nextRow(cut, end, false);
+                }
+            }
+            chunks[i].begin = p;
+            chunks[i].end = cut;
+            p = cut;
+        }
+
+        time_t now = time(nullptr);
+        parallelFor(chunkCount, [&](size_t i) { parseChunk(chunks[i], now); });
+
+        // Plaintext passwords may all sit in one chunk, so every thread
+        // takes the next one from the whole file rather than its own chunk's
+        std::vector<Account*> toHash;
+        for (auto& chunk : chunks) {
+            for (size_t i : chunk.plaintext) {
+                toHash.push_back(&chunk.accounts[i]);
+            }
+        }
+        std::atomic<size_t> nextHash(0);
+        parallelFor(std::min<size_t>(threads, toHash.size()), [&](size_t) {
+            for (size_t i; (i = nextHash.fetch_add(1)) < toHash.size();) {
+                toHash[i]->password = hashCredential(toHash[i]->password);
+            }
+        });
+
+        Batch batch;
+        batch.counts.hashed = toHash.size();
+        for (auto& chunk : chunks) {
+            batch.counts.imported += chunk.accounts.size();
+            batch.counts.transactions += chunk.transactions;
+            batch.counts.rejected += chunk.rejected;
+            batch.parts.push_back(std::move(chunk.accounts));
+        }
+        return batch;
+    }
+
+    // Appends the batch's accounts to `accounts`, numbering them from
+    // `nextAccountNumber`, which is advanced past the last one. The batch is
+    // left empty.
+    static ImportResult append(Batch& batch, std::vector<Account>& accounts, int& nextAccountNumber) {
+        ImportResult result = batch.counts;
+        size_t partCount = batch.parts.size();
+        std::vector<size_t> offsets(partCount);
+        for (size_t i = 0, total = 0; i < partCount; i++) {
+            offsets[i] = total;
+            total += batch.parts[i].size();
+        }
+
+        size_t base = accounts.size();
+        int firstNumber = nextAccountNumber;
+        accounts.resize(base + result.imported);
+
+        parallelFor(partCount, [&](size_t i) {
+            int number = firstNumber + (int)offsets[i];
+            Account* out = &accounts[base + offsets[i]];
+            for (auto& account : batch.parts[i]) {
+                account.accountNumber = number++;
+                for (auto& t : account.transactions) {
+                    (t.fromAccount == 0 ? t.fromAccount : t.toAccount) = account.accountNumber;
+                }
+                *out++ = std::move(account);
+            }
+            std::vector<Account>().swap(batch.parts[i]);
+        });
+        batch.parts.clear();
+        batch.counts = ImportResult();
+
+        nextAccountNumber += (int)result.imported;
+        result.firstAccountNumber = firstNumber;
+        result.lastAccountNumber = nextAccountNumber - 1;
+        return result;
+    }
+
+    static ImportResult import(const std::string& path, std::vector<Account>& accounts,
+                               int& nextAccountNumber, unsigned threads = 0) {
+        Batch batch = load(path, threads);
+        return append(batch, accounts, nextAccountNumber);
+    }
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include "Account.hpp"
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Deposits to one heavily-credited account, spread over stripes.
+//
+// Each thread credits its own stripe (own cache line, own mutex), so
+// concurrent deposits do not touch a shared line or the ledger's writer lock.
+// The account's real balance and history only change when the writer folds
+// the stripes in with settle(), in one commit like any other; until then the
+// credits are pending, which pending() reports without taking any lock. Only
+// money entering the bank is queued here: a transfer credits the receiver in
+// the same commit as its debit, so every published version balances, and
+// transfers still serialize on the writer lock even into a hot account.
+class HotAccount {
+public:
+    static const int STRIPES = 16;
+    static const size_t FOLD_BATCH = 256;   // queued credits per stripe before asking for a fold
+
+private:
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+        std::atomic<Money> pending{0};      // written under mutex, read without it
+        time_t oldest = 0;                  // timestamp of the first queued credit
+        std::vector<Transaction> transactions;
+    };
+
+    int accountNumber;
+    Stripe stripes[STRIPES];
+
+    static Stripe& localStripe(Stripe* stripes) {
+        static std::atomic<unsigned> nextThread(0);
+        static thread_local unsigned thread = nextThread.fetch_add(1);
+        return stripes[thread % STRIPES];
+    }
+
+public:
+    explicit HotAccount(int number) : accountNumber(number) {}
+
+    int number() const { return accountNumber; }
+
+    // Queues a credit (transaction id is assigned on folding). Returns true
+    // when the caller should settle: this stripe has a full batch queued, or
+    // has been holding credits since an earlier second.
+    bool credit(const Transaction& t) {
+        Stripe& s = localStripe(stripes);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.transactions.empty()) {
+            s.oldest = t.timestamp;
+        }
+        s.pending.store(s.pending.load(std::memory_order_relaxed) + t.amount, std::memory_order_relaxed);
+        s.transactions.push_back(t);
+        return s.transactions.size() >= FOLD_BATCH || t.timestamp > s.oldest;
+    }
+
+    // Credits queued but not settled yet, without taking any lock. Read it
+    // after the balance: a credit settled in between may then be missed,
+    // but is never counted twice.
+    Money pending() const {
+        Money total = 0;
+        for (const auto& s : stripes) {
+            total += s.pending.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Folds every queued credit into `account` in timestamp order. Caller
+    // holds the ledger's writer lock. Returns the number of credits folded.
+    size_t settle(Account& account) {
+        std::vector<Transaction> folded;
+        Money total = 0;
+        for (auto& s : stripes) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (folded.empty()) {
+                folded.swap(s.transactions);
+            } else {
+                folded.insert(folded.end(), s.transactions.begin(), s.transactions.end());
+                s.transactions.clear();
+            }
+            total += s.pending.load(std::memory_order_relaxed);
+            s.pending.store(0, std::memory_order_relaxed);
+        }
+        if (folded.empty()) {
+            return 0;
+        }
+        std::stable_sort(folded.begin(), folded.end(),
+                         [](const Transaction& a, const Transaction& b) { return a.timestamp < b.timestamp; });
+        account.balance += total;
+        for (auto& t : folded) {
+            t.id = account.transactions.size() + 1;
+            account.transactions.push_back(std::move(t));
+        }
+        return folded.size();
+    }
+};
+
+// Which accounts run hot, and promotion of new ones.
+//
+// Lookups are lock-free: a short fixed table that is only written on
+// promotion, so readers on every core share it read-only. Promotion counts
+// deposits per account over the current second; those counts are only
+// touched under the ledger's writer lock, where every ordinary deposit
+// already runs. Transfers do not count, since being hot would not take them
+// off the lock. Promoted accounts stay hot.
+class HotAccountTable {
+public:
+    static const int MAX_HOT = 64;
+
+private:
+    std::atomic<int> numbers[MAX_HOT];
+    std::atomic<HotAccount*> accounts[MAX_HOT];
+    std::atomic<int> count;
+    std::atomic<unsigned> threshold;
+
+    // Writer-lock only
+    time_t currentSecond;
+    std::unordered_map<int, unsigned> deposits;
+
+public:
+    explicit HotAccountTable(unsigned depositsPerSecond = 1000)
+        : count(0), threshold(depositsPerSecond), currentSecond(0) {
+        for (int i = 0; i < MAX_HOT; i++) {
+            numbers[i].store(0, std::memory_order_relaxed);
+            accounts[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    HotAccountTable(const HotAccountTable&) = delete;
+    HotAccountTable& operator=(const HotAccountTable&) = delete;
+
+    ~HotAccountTable() {
+        for (int i = 0; i < count.load(); i++) {
+            delete accounts[i].load();
+        }
+    }
+
+    // 0 disables promotion
+    void setThreshold(unsigned depositsPerSecond) {
+        threshold.store(depositsPerSecond, std::memory_order_relaxed);
+    }
+
+    HotAccount* find(int accountNumber) const {
+        int n = count.load(std::memory_order_acquire);
+        for (int i = 0; i < n; i++) {
+            if (numbers[i].load(std::memory_order_relaxed) == accountNumber) {
+                return accounts[i].load(std::memory_order_relaxed);
+            }
+        }
+        return nullptr;
+    }
+
+    // Writer lock held. Promotes the account now, if there is room.
+    HotAccount* promote(int accountNumber) {
+        HotAccount* hot = find(accountNumber);
+        int n = count.load(std::memory_order_relaxed);
+        if (hot != nullptr || n == MAX_HOT) {
+            return hot;
+        }
+        hot = new HotAccount(accountNumber);
+        accounts[n].store(hot, std::memory_order_relaxed);
+        numbers[n].store(accountNumber, std::memory_order_relaxed);
+        count.store(n + 1, std::memory_order_release);
+        return hot;
+    }
+
+    // Writer lock held. Counts one ordinary deposit and promotes the account
+    // once it reaches the threshold within one second.
+    void noteDeposit(int accountNumber, time_t now) {
+        unsigned limit = threshold.load(std::memory_order_relaxed);
+        if (limit == 0) {
+            return;
+        }
+        if (now != currentSecond) {
+            currentSecond = now;
+            deposits.clear();
+        }
+        if (++deposits[accountNumber] >= limit) {
+            promote(accountNumber);
+            deposits.erase(accountNumber);
+        }
+    }
+
+    template <typename F>
+    void forEach(F f) {
+        int n = count.load(std::memory_order_acquire);
+        for (int i = 0; i < n; i++) {
+            f(*accounts[i].load(std::memory_order_relaxed));
+        }
+    }
+};
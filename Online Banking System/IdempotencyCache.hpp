@@ -0,0 +1,149 @@
+#pragma once
+#include <ctime>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers the result of recent requests by idempotency key so a client
+// retry gets the original answer instead of running the operation again.
+//
+// Fixed capacity, split into independently locked shards. Each shard is a
+// CLOCK ring: a hit sets the entry's reference bit, and when the shard is
+// full the hand evicts the first expired or unreferenced entry it meets.
+// Entries also expire after a fixed time to live.
+//
+// Each entry also keeps a hash of the request it answered, so a key reused
+// for a different request (another amount or recipient) is reported as a
+// mismatch instead of replaying an unrelated result.
+enum IdempotencyLookup { IDEMPOTENCY_MISS, IDEMPOTENCY_HIT, IDEMPOTENCY_MISMATCH };
+
+class IdempotencyCache {
+private:
+    static const size_t SHARDS = 16;
+
+    struct Entry {
+        std::string key;
+        size_t request;
+        bool result;
+        time_t expires;
+        bool referenced;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, size_t> index;
+        std::vector<Entry> entries;
+        size_t hand = 0;
+    };
+
+    Shard shards[SHARDS];
+    size_t shardCapacity;
+    time_t ttl;
+
+    Shard& shardFor(const std::string& key) {
+        return shards[std::hash<std::string>()(key) % SHARDS];
+    }
+
+    // Picks the entry to overwrite in a full shard
+    static size_t evict(Shard& shard, time_t now) {
+        for (;;) {
+            Entry& e = shard.entries[shard.hand];
+            size_t victim = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+            if (e.expires <= now || !e.referenced) {
+                shard.index.erase(e.key);
+                return victim;
+            }
+            e.referenced = false;
+        }
+    }
+
+public:
+    IdempotencyCache(size_t capacity = 1 << 16, time_t ttlSeconds = 24 * 60 * 60)
+        : shardCapacity((capacity + SHARDS - 1) / SHARDS), ttl(ttlSeconds) {
+        if (shardCapacity == 0) {
+            shardCapacity = 1;
+        }
+        for (auto& shard : shards) {
+            shard.index.reserve(shardCapacity);
+            shard.entries.reserve(shardCapacity);
+        }
+    }
+
+    IdempotencyLookup lookup(const std::string& key, size_t request, bool& result, time_t now) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return IDEMPOTENCY_MISS;
+        }
+        Entry& e = shard.entries[it->second];
+        if (e.expires <= now) {
+            return IDEMPOTENCY_MISS;
+        }
+        if (e.request != request) {
+            return IDEMPOTENCY_MISMATCH;
+        }
+        e.referenced = true;
+        result = e.result;
+        return IDEMPOTENCY_HIT;
+    }
+
+    void insert(const std::string& key, size_t request, bool result, time_t now) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Entry& e = shard.entries[it->second];
+            e.request = request;
+            e.result = result;
+            e.expires = now + ttl;
+            e.referenced = true;
+            return;
+        }
+
+        size_t slot;
+        if (shard.entries.size() < shardCapacity) {
+            slot = shard.entries.size();
+            shard.entries.push_back(Entry());
+        } else {
+            slot = evict(shard, now);
+        }
+
+        Entry& e = shard.entries[slot];
+        e.key = key;
+        e.request = request;
+        e.result = result;
+        e.expires = now + ttl;
+        e.referenced = false;
+        shard.index[key] = slot;
+    }
+
+    // Calls f(key, request, result, storedAt) for every entry not expired
+    // at `now`, where storedAt is the `now` it was inserted with, so
+    // insert(key, request, result, storedAt) recreates it elsewhere.
+    template <typename F>
+    void forEach(time_t now, F f) {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& e : shard.entries) {
+                if (e.expires > now) {
+                    f(e.key, e.request, e.result, e.expires - ttl);
+                }
+            }
+        }
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.index.size();
+        }
+        return total;
+    }
+};
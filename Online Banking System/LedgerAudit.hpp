@@ -0,0 +1,195 @@
+#pragma once
+#include "Account.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Transaction types the ledger writes, by how they move money
+enum TransactionKind {
+    KIND_DEPOSIT, KIND_WITHDRAWAL, KIND_TRANSFER_IN, KIND_TRANSFER_OUT,
+    KIND_INTEREST, KIND_FEE, KIND_OPENING, KIND_UNKNOWN, KIND_COUNT
+};
+
+inline TransactionKind transactionKind(const std::string& type) {
+    switch (type.size()) {
+    case 3:  return type == "FEE" ? KIND_FEE : KIND_UNKNOWN;
+    case 7:  return type == "DEPOSIT" ? KIND_DEPOSIT : type == "OPENING" ? KIND_OPENING : KIND_UNKNOWN;
+    case 8:  return type == "INTEREST" ? KIND_INTEREST : KIND_UNKNOWN;
+    case 10: return type == "WITHDRAWAL" ? KIND_WITHDRAWAL : KIND_UNKNOWN;
+    case 11: return type == "TRANSFER_IN" ? KIND_TRANSFER_IN : KIND_UNKNOWN;
+    case 12: return type == "TRANSFER_OUT" ? KIND_TRANSFER_OUT : KIND_UNKNOWN;
+    default: return KIND_UNKNOWN;
+    }
+}
+
+// -1 for kinds that take money out of the account, +1 otherwise
+inline Money kindSign(TransactionKind kind) {
+    return (kind == KIND_WITHDRAWAL || kind == KIND_TRANSFER_OUT || kind == KIND_FEE) ? -1 : 1;
+}
+
+struct AuditMismatch {
+    int accountNumber;
+    Money recorded;      // balance on the account
+    Money recomputed;    // balance implied by its history
+};
+
+struct AuditResult {
+    size_t accountsChecked = 0;
+    size_t transactionsChecked = 0;
+    size_t unknownTransactions = 0;          // types the audit cannot sign
+    Money totalRecorded = 0;
+    Money totalRecomputed = 0;
+    Money kindTotals[KIND_COUNT] = {};       // per kind, unsigned
+    std::vector<AuditMismatch> mismatches;   // by account number
+
+    // Money moved between accounts must net to zero
+    bool transfersBalance() const {
+        return kindTotals[KIND_TRANSFER_IN] == kindTotals[KIND_TRANSFER_OUT];
+    }
+
+    // Everything held must have come in from outside the bank
+    Money externalNet() const {
+        return kindTotals[KIND_DEPOSIT] + kindTotals[KIND_INTEREST] + kindTotals[KIND_OPENING]
+             - kindTotals[KIND_WITHDRAWAL] - kindTotals[KIND_FEE];
+    }
+
+    bool clean() const {
+        return mismatches.empty() && unknownTransactions == 0 && transfersBalance() &&
+               totalRecorded == totalRecomputed && totalRecorded == externalNet();
+    }
+};
+
+// Recomputes every balance from its transaction history.
+//
+// Accounts are handed out to workers in chunks. For each chunk a worker first
+// gathers the signed amounts of all its transactions into one contiguous
+// array, then sums each account's slice of it; the sum is a plain integer
+// reduction with independent accumulators, which the compiler turns into
+// vector adds. Money is integer minor units, so every comparison is exact and
+// the result does not depend on how the work was split. It reads one pinned
+// snapshot, so commits carry on while it runs.
+class LedgerAudit {
+private:
+    static constexpr size_t CHUNK = 1024;   // accounts per unit of work
+
+    struct Scratch {
+        std::vector<Money> amounts;     // signed, all accounts of the chunk
+        std::vector<size_t> offsets;    // start of each account's slice
+        std::vector<int> numbers;       // the chunk's accounts present in the snapshot
+        std::vector<Money> balances;
+        AccountRef account;
+    };
+
+    struct Partial {
+        size_t accounts = 0;
+        size_t transactions = 0;
+        size_t unknown = 0;
+        Money recorded = 0;
+        Money recomputed = 0;
+        Money kindTotals[KIND_COUNT] = {};
+        std::vector<AuditMismatch> mismatches;
+    };
+
+    static Money sum(const Money* values, size_t n) {
+        Money a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            a0 += values[i];
+            a1 += values[i + 1];
+            a2 += values[i + 2];
+            a3 += values[i + 3];
+        }
+        for (; i < n; i++) {
+            a0 += values[i];
+        }
+        return (a0 + a1) + (a2 + a3);
+    }
+
+    static void auditChunk(const SnapshotLedger::Snapshot& snapshot, size_t begin, size_t end,
+                           Scratch& s, Partial& p) {
+        s.amounts.clear();
+        s.offsets.clear();
+        s.numbers.clear();
+        s.balances.clear();
+
+        for (size_t i = begin; i < end; i++) {
+            if (!snapshot.readAt(i, s.account)) {
+                continue;
+            }
+            s.offsets.push_back(s.amounts.size());
+            s.numbers.push_back(s.account.accountNumber);
+            s.balances.push_back(s.account.balance);
+            for (const Transaction* t : s.account.transactions) {
+                TransactionKind kind = transactionKind(t->type);
+                p.kindTotals[kind] += t->amount;
+                p.unknown += kind == KIND_UNKNOWN;
+                s.amounts.push_back(kind == KIND_UNKNOWN ? 0 : kindSign(kind) * t->amount);
+            }
+        }
+        size_t n = s.numbers.size();
+        s.offsets.push_back(s.amounts.size());
+
+        for (size_t i = 0; i < n; i++) {
+            Money recomputed = sum(s.amounts.data() + s.offsets[i], s.offsets[i + 1] - s.offsets[i]);
+            p.recorded += s.balances[i];
+            p.recomputed += recomputed;
+            if (recomputed != s.balances[i]) {
+                p.mismatches.push_back({s.numbers[i], s.balances[i], recomputed});
+            }
+        }
+        p.accounts += n;
+        p.transactions += s.amounts.size();
+    }
+
+public:
+    static AuditResult run(const SnapshotLedger::Snapshot& snapshot, unsigned threads = 0) {
+        size_t slots = snapshot.accountSlots();
+        size_t chunkCount = (slots + CHUNK - 1) / CHUNK;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(chunkCount, 1)));
+
+        std::vector<Partial> partials(threads);
+        std::atomic<size_t> nextChunk(0);
+        auto worker = [&](unsigned w) {
+            Scratch scratch;
+            for (;;) {
+                size_t chunk = nextChunk.fetch_add(1);
+                if (chunk >= chunkCount) {
+                    break;
+                }
+                size_t begin = chunk * CHUNK;
+                auditChunk(snapshot, begin, std::min(begin + CHUNK, slots), scratch, partials[w]);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned w = 1; w < threads; w++) {
+            pool.emplace_back(worker, w);
+        }
+        worker(0);
+        for (auto& t : pool) {
+            t.join();
+        }
+
+        AuditResult result;
+        for (auto& p : partials) {
+            result.accountsChecked += p.accounts;
+            result.transactionsChecked += p.transactions;
+            result.unknownTransactions += p.unknown;
+            result.totalRecorded += p.recorded;
+            result.totalRecomputed += p.recomputed;
+            for (int k = 0; k < KIND_COUNT; k++) {
+                result.kindTotals[k] += p.kindTotals[k];
+            }
+            result.mismatches.insert(result.mismatches.end(), p.mismatches.begin(), p.mismatches.end());
+        }
+        std::sort(result.mismatches.begin(), result.mismatches.end(),
+                  [](const AuditMismatch& a, const AuditMismatch& b) { return a.accountNumber < b.accountNumber; });
+        return result;
+    }
+};
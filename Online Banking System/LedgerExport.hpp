@@ -0,0 +1,460 @@
+#pragma once
+#include "Account.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum ExportFormat { EXPORT_CSV = 1, EXPORT_COLUMNAR };
+
+struct ExportResult {
+    size_t accounts = 0;
+    size_t transactions = 0;
+    size_t bytes = 0;
+    unsigned parts = 0;
+};
+
+// Appends to a file through one fixed-size buffer.
+//
+// A failed write throws std::runtime_error at the point it happens. close()
+// flushes, closes and reports whether everything reached the file; a writer
+// destroyed without close() (e.g. while an exception unwinds) just closes.
+class BufferedFileWriter {
+private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    std::string path;
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used;
+    size_t written;
+
+    void fail() {
+        throw std::runtime_error("Error writing " + path);
+    }
+
+public:
+    explicit BufferedFileWriter(const std::string& filePath)
+        : path(filePath), file(std::fopen(filePath.c_str(), "wb")), buffer(BUFFER_SIZE), used(0), written(0) {
+        if (file == nullptr) {
+            throw std::runtime_error("Cannot open " + path + " for writing");
+        }
+    }
+
+    BufferedFileWriter(const BufferedFileWriter&) = delete;
+    BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+    ~BufferedFileWriter() {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+
+    const std::string& name() const { return path; }
+
+    void write(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) {
+                if (std::fwrite(bytes, 1, size, file) != size) {
+                    fail();
+                }
+                written += size;
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, bytes, size);
+        used += size;
+    }
+
+    void put(char c) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+
+    // Hands the buffer to the C library and on to the OS
+    void flush() {
+        if (used > 0) {
+            if (std::fwrite(buffer.data(), 1, used, file) != used) {
+                fail();
+            }
+            written += used;
+            used = 0;
+        }
+        if (std::fflush(file) != 0) {
+            fail();
+        }
+    }
+
+    // False if any buffered data could not be written or the close failed
+    bool close() {
+        if (file == nullptr) {
+            return true;
+        }
+        bool ok = true;
+        if (used > 0) {
+            ok = std::fwrite(buffer.data(), 1, used, file) == used;
+            written += used;
+            used = 0;
+        }
+        ok = std::fflush(file) == 0 && ok;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    size_t bytesWritten() const { return written + used; }
+};
+
+// CSV rows, written field by field straight from the ledger structures.
+class CsvLedgerWriter {
+private:
+    BufferedFileWriter out;
+
+    template <typename T>
+    void number(T value) {
+        char text[32];
+        auto r = std::to_chars(text, text + sizeof(text), value);
+        out.write(text, r.ptr - text);
+    }
+
+    void money(Money value) {
+        char text[24];
+        out.write(text, formatMoney(value, text) - text);
+    }
+
+    // Quotes a field only when it contains a separator, quote or newline
+    void text(const std::string& value) {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            out.write(value.data(), value.size());
+            return;
+        }
+        out.put('"');
+        for (char c : value) {
+            if (c == '"') {
+                out.put('"');
+            }
+            out.put(c);
+        }
+        out.put('"');
+    }
+
+public:
+    explicit CsvLedgerWriter(const std::string& path) : out(path) {}
+
+    void accountHeader() {
+        const char header[] = "account_number,name,type,balance,creation_date\n";
+        out.write(header, sizeof(header) - 1);
+    }
+
+    void transactionHeader() {
+        const char header[] = "account_number,id,type,amount,timestamp,from_account,to_account,description\n";
+        out.write(header, sizeof(header) - 1);
+    }
+
+    void account(const AccountRef& a) {
+        number(a.accountNumber); out.put(',');
+        text(*a.name); out.put(',');
+        text(a.type == SAVINGS ? "SAVINGS" : "CURRENT"); out.put(',');
+        money(a.balance); out.put(',');
+        number((long long)a.creationDate); out.put('\n');
+    }
+
+    void transaction(int accountNumber, const Transaction& t) {
+        number(accountNumber); out.put(',');
+        number(t.id); out.put(',');
+        text(t.type); out.put(',');
+        money(t.amount); out.put(',');
+        number((long long)t.timestamp); out.put(',');
+        number(t.fromAccount); out.put(',');
+        number(t.toAccount); out.put(',');
+        text(t.description); out.put('\n');
+    }
+
+    void close() {
+        if (!out.close()) {
+            throw std::runtime_error("Error writing " + out.name());
+        }
+    }
+
+    size_t bytesWritten() const { return out.bytesWritten(); }
+};
+
+// Column-chunked binary transaction file.
+//
+// Layout: "LCOL1\n", then row groups of up to ROW_GROUP rows, then a
+// terminating group with zero rows and the total row count (u64). Each group
+// is a u32 row count followed by its columns in order. A column is a u8
+// encoding, a u64 byte length and the encoded bytes:
+//   account_number, id, timestamp, from_account, to_account - DELTA_VARINT
+//     (zig-zag varint of the difference from the previous row)
+//   type        - DICTIONARY (u8 entry count, varint-length strings, u8 codes)
+//   amount      - PLAIN_I64 (little-endian int64 minor units)
+//   description - PLAIN_STRING (varint length + bytes per row)
+// Only one row group is buffered at a time.
+class ColumnarLedgerWriter {
+public:
+    // PLAIN_F64 (doubles) is only found in files written before amounts
+    // became integer minor units.
+    enum Encoding : uint8_t { DELTA_VARINT = 1, DICTIONARY = 2, PLAIN_F64 = 3, PLAIN_STRING = 4, PLAIN_I64 = 5 };
+    static const size_t ROW_GROUP = 65536;
+
+private:
+    struct DeltaColumn {
+        std::vector<uint8_t> bytes;
+        long long previous = 0;
+
+        void add(long long value) {
+            long long delta = value - previous;
+            previous = value;
+            uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+            while (zigzag >= 0x80) {
+                bytes.push_back((uint8_t)(zigzag | 0x80));
+                zigzag >>= 7;
+            }
+            bytes.push_back((uint8_t)zigzag);
+        }
+
+        void reset() {
+            bytes.clear();
+            previous = 0;
+        }
+    };
+
+    BufferedFileWriter out;
+    size_t rows;
+    size_t totalRows;
+    bool closed;
+
+    DeltaColumn accountColumn, idColumn, timestampColumn, fromColumn, toColumn;
+    std::vector<std::string> typeDictionary;
+    std::vector<uint8_t> typeCodes;
+    std::vector<Money> amounts;
+    std::vector<uint8_t> descriptions;
+
+    static void varint(std::vector<uint8_t>& bytes, uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back((uint8_t)value);
+    }
+
+    void column(Encoding encoding, const void* data, uint64_t size) {
+        out.put((char)encoding);
+        out.write(&size, sizeof(size));
+        out.write(data, size);
+    }
+
+    uint8_t typeCode(const std::string& type) {
+        for (size_t i = 0; i < typeDictionary.size(); i++) {
+            if (typeDictionary[i] == type) {
+                return (uint8_t)i;
+            }
+        }
+        if (typeDictionary.size() == 255) {
+            throw std::runtime_error("Too many distinct transaction types in one row group");
+        }
+        typeDictionary.push_back(type);
+        return (uint8_t)(typeDictionary.size() - 1);
+    }
+
+    void flushGroup() {
+        if (rows == 0) {
+            return;
+        }
+        uint32_t count = (uint32_t)rows;
+        out.write(&count, sizeof(count));
+
+        column(DELTA_VARINT, accountColumn.bytes.data(), accountColumn.bytes.size());
+        column(DELTA_VARINT, idColumn.bytes.data(), idColumn.bytes.size());
+
+        std::vector<uint8_t> dictionary;
+        dictionary.push_back((uint8_t)typeDictionary.size());
+        for (const auto& type : typeDictionary) {
+            varint(dictionary, type.size());
+            dictionary.insert(dictionary.end(), type.begin(), type.end());
+        }
+        dictionary.insert(dictionary.end(), typeCodes.begin(), typeCodes.end());
+        column(DICTIONARY, dictionary.data(), dictionary.size());
+
+        column(PLAIN_I64, amounts.data(), amounts.size() * sizeof(Money));
+        column(DELTA_VARINT, timestampColumn.bytes.data(), timestampColumn.bytes.size());
+        column(DELTA_VARINT, fromColumn.bytes.data(), fromColumn.bytes.size());
+        column(DELTA_VARINT, toColumn.bytes.data(), toColumn.bytes.size());
+        column(PLAIN_STRING, descriptions.data(), descriptions.size());
+
+        accountColumn.reset();
+        idColumn.reset();
+        timestampColumn.reset();
+        fromColumn.reset();
+        toColumn.reset();
+        typeDictionary.clear();
+        typeCodes.clear();
+        amounts.clear();
+        descriptions.clear();
+        rows = 0;
+    }
+
+public:
+    explicit ColumnarLedgerWriter(const std::string& path) : out(path), rows(0), totalRows(0), closed(false) {
+        const char magic[] = "LCOL1\n";
+        out.write(magic, sizeof(magic) - 1);
+        amounts.reserve(ROW_GROUP);
+        typeCodes.reserve(ROW_GROUP);
+    }
+
+    // Writes the last row group and the trailer and closes the file;
+    // throws if any of it could not be written
+    void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        flushGroup();
+        uint32_t end = 0;
+        uint64_t total = totalRows;
+        out.write(&end, sizeof(end));
+        out.write(&total, sizeof(total));
+        if (!out.close()) {
+            throw std::runtime_error("Error writing " + out.name());
+        }
+    }
+
+    void transaction(int accountNumber, const Transaction& t) {
+        accountColumn.add(accountNumber);
+        idColumn.add(t.id);
+        typeCodes.push_back(typeCode(t.type));
+        amounts.push_back(t.amount);
+        timestampColumn.add((long long)t.timestamp);
+        fromColumn.add(t.fromAccount);
+        toColumn.add(t.toAccount);
+        varint(descriptions, t.description.size());
+        descriptions.insert(descriptions.end(), t.description.begin(), t.description.end());
+
+        totalRows++;
+        if (++rows == ROW_GROUP) {
+            flushGroup();
+        }
+    }
+
+    size_t bytesWritten() const { return out.bytesWritten(); }
+};
+
+// Dumps every account and transaction in `snapshot`, split into `parts`
+// contiguous account ranges of roughly equal transaction count, each written
+// by its own thread:
+//   <dir>/accounts-<n>.csv and <dir>/transactions-<n>.csv, or
+//   <dir>/accounts-<n>.csv and <dir>/transactions-<n>.lcol
+// Rows are encoded straight from the snapshot's history; memory use per part
+// is fixed and writers keep committing meanwhile. Throws if any file could
+// not be written in full.
+inline ExportResult exportLedger(const SnapshotLedger::Snapshot& snapshot, const std::string& directory,
+                                 ExportFormat format, unsigned parts = 0) {
+    size_t slots = snapshot.accountSlots();
+    if (parts == 0) {
+        parts = std::max(1u, std::thread::hardware_concurrency());
+    }
+    parts = (unsigned)std::max<size_t>(1, std::min<size_t>(parts, slots));
+
+    std::vector<size_t> history(slots);
+    size_t totalRows = 0;
+    for (size_t i = 0; i < slots; i++) {
+        history[i] = snapshot.historySize(i);
+        totalRows += history[i] + 1;
+    }
+
+    // Range boundaries by cumulative rows, so parts take similar time
+    std::vector<size_t> bounds(1, 0);
+    size_t rows = 0;
+    for (size_t i = 0; i < slots && bounds.size() < parts; i++) {
+        rows += history[i] + 1;
+        if (rows * parts >= totalRows * bounds.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    if (bounds.back() != slots || bounds.size() == 1) {
+        bounds.push_back(slots);
+    }
+    parts = (unsigned)(bounds.size() - 1);
+
+    std::vector<ExportResult> results(parts);
+    std::vector<std::string> errors(parts);
+
+    auto writePart = [&](unsigned part) {
+        try {
+            std::string suffix = "-" + std::to_string(part);
+            ExportResult& r = results[part];
+            AccountRef account;
+
+            CsvLedgerWriter accountFile(directory + "/accounts" + suffix + ".csv");
+            accountFile.accountHeader();
+            for (size_t i = bounds[part]; i < bounds[part + 1]; i++) {
+                if (snapshot.readAt(i, account)) {
+                    accountFile.account(account);
+                    r.accounts++;
+                }
+            }
+            accountFile.close();
+
+            if (format == EXPORT_CSV) {
+                CsvLedgerWriter txFile(directory + "/transactions" + suffix + ".csv");
+                txFile.transactionHeader();
+                for (size_t i = bounds[part]; i < bounds[part + 1]; i++) {
+                    if (snapshot.readAt(i, account)) {
+                        for (const Transaction* t : account.transactions) {
+                            txFile.transaction(account.accountNumber, *t);
+                        }
+                        r.transactions += account.transactions.size();
+                    }
+                }
+                txFile.close();
+                r.bytes = accountFile.bytesWritten() + txFile.bytesWritten();
+            } else {
+                ColumnarLedgerWriter txFile(directory + "/transactions" + suffix + ".lcol");
+                for (size_t i = bounds[part]; i < bounds[part + 1]; i++) {
+                    if (snapshot.readAt(i, account)) {
+                        for (const Transaction* t : account.transactions) {
+                            txFile.transaction(account.accountNumber, *t);
+                        }
+                        r.transactions += account.transactions.size();
+                    }
+                }
+                txFile.close();
+                r.bytes = accountFile.bytesWritten() + txFile.bytesWritten();
+            }
+        } catch (const std::exception& e) {
+            errors[part] = e.what();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned part = 1; part < parts; part++) {
+        workers.emplace_back(writePart, part);
+    }
+    writePart(0);
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    ExportResult total;
+    total.parts = parts;
+    for (unsigned part = 0; part < parts; part++) {
+        if (!errors[part].empty()) {
+            throw std::runtime_error(errors[part]);
+        }
+        total.accounts += results[part].accounts;
+        total.transactions += results[part].transactions;
+        total.bytes += results[part].bytes;
+    }
+    return total;
+}
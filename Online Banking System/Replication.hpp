@@ -0,0 +1,726 @@
+#pragma once
+#include "Account.hpp"
+#include "IdempotencyCache.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// An account's balance and end-of-day state after a commit
+struct ReplicatedBalance {
+    int accountNumber;
+    Money balance;
+    int32_t interestCarry;
+    int32_t lastAccrualDate;
+};
+
+// An idempotency key remembered by a commit, so a retry sent to the replica
+// after a failover is still answered from the cache
+struct ReplicatedKey {
+    std::string key;
+    uint64_t request;
+    bool result;
+    int64_t storedAt;
+};
+
+// Everything one primary commit changed, as shipped to a replica
+struct ReplicatedBatch {
+    uint64_t seq = 0;                                       // primary commit sequence
+    int64_t primaryTimeNs = 0;                              // primary wall clock at commit
+    bool fullState = false;                                 // whole ledger; may repeat what the replica has
+    std::vector<Account> accounts;                          // created, without history
+    std::vector<std::pair<int, Transaction>> transactions;  // appended, in order
+    std::vector<ReplicatedBalance> balances;                // resulting balances
+    std::vector<ReplicatedKey> keys;                        // idempotency keys remembered
+
+    void clear() {
+        fullState = false;
+        accounts.clear();
+        transactions.clear();
+        balances.clear();
+        keys.clear();
+    }
+};
+
+struct ReplicationStatus {
+    bool connected = false;
+    uint64_t seq = 0;           // primary: last committed, replica: last applied
+    uint64_t ackedSeq = 0;      // primary: last applied by the replica
+    double lastLagMs = 0.0;     // replica: commit-to-apply delay of the last batch
+    double maxLagMs = 0.0;
+    bool lagging = false;       // primary: replica dropped for falling behind, not re-synced yet
+    uint64_t resyncs = 0;       // primary: replicas dropped for lagging; replica: re-syncs after reconnecting
+};
+
+// Wire format: a stream of records, each a u8 kind and its fields in host
+// byte order (both ends run on the same machine). Strings are a u32 length
+// and bytes. A batch is any number of ACCOUNT / TRANSACTION / BALANCE / KEY
+// records closed by one COMMIT; a batch opened by FULL_STATE carries the
+// whole ledger.
+// The replica answers with its last applied sequence (u64) after each read.
+class ReplicationCodec {
+public:
+    enum Kind : uint8_t { ACCOUNT = 1, TRANSACTION = 2, BALANCE = 3, COMMIT = 4, FULL_STATE = 5, KEY = 6 };
+
+    template <typename T>
+    static void put(std::vector<char>& out, T value) {
+        const char* p = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    static void putString(std::vector<char>& out, const std::string& s) {
+        put<uint32_t>(out, (uint32_t)s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    static void account(std::vector<char>& out, const Account& a) {
+        account(out, a.accountNumber, a.type, a.creationDate, a.name, a.password);
+    }
+
+    static void account(std::vector<char>& out, int accountNumber, AccountType type, time_t creationDate,
+                        const std::string& name, const std::string& password) {
+        put<uint8_t>(out, ACCOUNT);
+        put<int32_t>(out, accountNumber);
+        put<uint8_t>(out, (uint8_t)type);
+        put<int64_t>(out, (int64_t)creationDate);
+        putString(out, name);
+        putString(out, password);
+    }
+
+    static void transaction(std::vector<char>& out, int accountNumber, const Transaction& t) {
+        put<uint8_t>(out, TRANSACTION);
+        put<int32_t>(out, accountNumber);
+        put<int32_t>(out, t.id);
+        put<int64_t>(out, t.amount);
+        put<int64_t>(out, (int64_t)t.timestamp);
+        put<int32_t>(out, t.fromAccount);
+        put<int32_t>(out, t.toAccount);
+        putString(out, t.type);
+        putString(out, t.description);
+    }
+
+    template <typename A>   // Account or AccountRef
+    static void balance(std::vector<char>& out, const A& a) {
+        put<uint8_t>(out, BALANCE);
+        put<int32_t>(out, a.accountNumber);
+        put<int64_t>(out, a.balance);
+        put<int32_t>(out, a.interestCarry);
+        put<int32_t>(out, a.lastAccrualDate);
+    }
+
+    static void key(std::vector<char>& out, const std::string& key, uint64_t request, bool result, time_t storedAt) {
+        put<uint8_t>(out, KEY);
+        put<uint64_t>(out, request);
+        put<uint8_t>(out, result ? 1 : 0);
+        put<int64_t>(out, (int64_t)storedAt);
+        putString(out, key);
+    }
+
+    static void fullState(std::vector<char>& out) {
+        put<uint8_t>(out, FULL_STATE);
+    }
+
+    static void commit(std::vector<char>& out, uint64_t seq, int64_t timeNs) {
+        put<uint8_t>(out, COMMIT);
+        put<uint64_t>(out, seq);
+        put<int64_t>(out, timeNs);
+    }
+
+    // Bounds-checked reader over received bytes
+    struct Reader {
+        const char* p;
+        const char* end;
+
+        template <typename T>
+        bool get(T& value) {
+            if (end - p < (ptrdiff_t)sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+
+        bool getString(std::string& s) {
+            uint32_t size;
+            if (!get(size) || end - p < (ptrdiff_t)size) {
+                return false;
+            }
+            s.assign(p, size);
+            p += size;
+            return true;
+        }
+    };
+
+    // Decodes one record into `batch`. Returns false, consuming nothing, if
+    // the record is not complete yet; sets `committed` on a COMMIT.
+    static bool decode(Reader& in, ReplicatedBatch& batch, bool& committed) {
+        Reader r = in;
+        uint8_t kind;
+        committed = false;
+        if (!r.get(kind)) {
+            return false;
+        }
+        switch (kind) {
+        case ACCOUNT: {
+            Account a;
+            int32_t number;
+            uint8_t type;
+            int64_t created;
+            if (!r.get(number) || !r.get(type) || !r.get(created) ||
+                !r.getString(a.name) || !r.getString(a.password)) {
+                return false;
+            }
+            a.accountNumber = number;
+            a.type = (AccountType)type;
+            a.creationDate = (time_t)created;
+            a.balance = 0;
+            batch.accounts.push_back(std::move(a));
+            break;
+        }
+        case TRANSACTION: {
+            Transaction t;
+            int32_t account, id, from, to;
+            int64_t timestamp;
+            if (!r.get(account) || !r.get(id) || !r.get(t.amount) || !r.get(timestamp) ||
+                !r.get(from) || !r.get(to) || !r.getString(t.type) || !r.getString(t.description)) {
+                return false;
+            }
+            t.id = id;
+            t.timestamp = (time_t)timestamp;
+            t.fromAccount = from;
+            t.toAccount = to;
+            batch.transactions.emplace_back(account, std::move(t));
+            break;
+        }
+        case BALANCE: {
+            int32_t account, carry, accrued;
+            Money value;
+            if (!r.get(account) || !r.get(value) || !r.get(carry) || !r.get(accrued)) {
+                return false;
+            }
+            batch.balances.push_back({account, value, carry, accrued});
+            break;
+        }
+        case KEY: {
+            ReplicatedKey k;
+            uint8_t result;
+            if (!r.get(k.request) || !r.get(result) || !r.get(k.storedAt) || !r.getString(k.key)) {
+                return false;
+            }
+            k.result = result != 0;
+            batch.keys.push_back(std::move(k));
+            break;
+        }
+        case FULL_STATE:
+            batch.fullState = true;
+            break;
+        case COMMIT:
+            if (!r.get(batch.seq) || !r.get(batch.primaryTimeNs)) {
+                return false;
+            }
+            committed = true;
+            break;
+        default:
+            throw std::runtime_error("Corrupt replication stream");
+        }
+        in = r;
+        return true;
+    }
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
+
+#ifndef _WIN32
+
+// Primary side of log shipping over a Unix domain socket.
+//
+// Installed as the ledger's CommitListener, it serializes every published
+// account change while the writer lock is held and hands whole commits to a
+// sender thread, which writes everything queued since its last write in one
+// go, so shipping is batched and runs alongside new commits. The owner
+// reports each idempotency key it stores under the writer lock through
+// remembered(), and it ships with the commit.
+//
+// When a replica connects it first gets the full ledger. The writer lock is
+// held only to pin a snapshot, copy the idempotency keys and start queueing
+// new commits; the snapshot is then streamed in pieces while writers carry
+// on, and the commits queued meanwhile follow it. One replica is served at a
+// time. Commits never wait for the replica: one that falls more than
+// MAX_PENDING behind is marked lagging and disconnected, and re-syncs from a
+// fresh full state when it reconnects. Install the listener before calling
+// start().
+class ReplicationPrimary : public CommitListener {
+private:
+    static const size_t MAX_PENDING = 64 << 20;   // bytes queued before the replica is dropped
+    static const size_t FULL_STATE_PIECE = 1 << 20;
+
+    std::string socketPath;
+    int listenFd;
+    int clientFd;
+    SnapshotLedger& ledger;
+    int firstAccountNumber;
+    IdempotencyCache& keys;
+
+    // Writer-lock side
+    std::vector<size_t> shipped;       // transactions already sent, per account
+    std::vector<char> scratch;         // records of the commit in progress
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<char> pending;
+    bool streaming;
+    bool stopping;
+    ReplicationStatus status;
+    std::thread worker;
+
+    void sendAll(const std::vector<char>& bytes) {
+        size_t sent = 0;
+        while (sent < bytes.size()) {
+            ssize_t n = send(clientFd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                throw std::runtime_error("Replica disconnected");
+            }
+            sent += (size_t)n;
+        }
+    }
+
+    void readAcks() {
+        uint64_t acks[64];
+        ssize_t n;
+        while ((n = recv(clientFd, acks, sizeof(acks), MSG_DONTWAIT)) > 0) {
+            if (n >= (ssize_t)sizeof(uint64_t)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                status.ackedSeq = acks[n / sizeof(uint64_t) - 1];
+            }
+        }
+    }
+
+    void serve() {
+        std::vector<char> batch;
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait_for(lock, std::chrono::milliseconds(100),
+                           [&] { return stopping || !streaming || !pending.empty(); });
+            if (stopping || !streaming) {
+                return;
+            }
+            batch.swap(pending);
+            lock.unlock();
+
+            if (!batch.empty()) {
+                sendAll(batch);
+                batch.clear();
+            }
+            readAcks();
+        }
+    }
+
+    void run() {
+        for (;;) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) {
+                    if (fd >= 0) {
+                        close(fd);
+                    }
+                    return;
+                }
+                clientFd = fd;
+            }
+            if (fd < 0) {
+                continue;
+            }
+
+            try {
+                {
+                    std::vector<char> bytes;
+                    SnapshotLedger::Snapshot snapshot = beginStreaming(bytes);
+                    sendFullState(snapshot, bytes);
+                }
+                serve();
+            } catch (const std::exception&) {
+                // replica went away; wait for the next one
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            streaming = false;
+            status.connected = false;
+            pending.clear();
+            close(clientFd);
+            clientFd = -1;
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    // Writer lock held, so this must not wait on the replica
+    void enqueue(const std::vector<char>& bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!streaming) {
+            return;
+        }
+        if (pending.size() + bytes.size() > MAX_PENDING) {
+            // The sender thread notices, drops the connection and waits for
+            // the replica to come back for a full state
+            streaming = false;
+            status.connected = false;
+            status.lagging = true;
+            status.resyncs++;
+            pending.clear();
+            shutdown(clientFd, SHUT_RDWR);
+            ready.notify_one();
+            return;
+        }
+        bool wake = pending.empty();
+        pending.insert(pending.end(), bytes.begin(), bytes.end());
+        if (wake) {
+            ready.notify_one();
+        }
+    }
+
+    // Pins the state a new replica starts from and starts queueing the
+    // commits after it; `bytes` gets the opening of the full state. Takes the
+    // writer lock for this only.
+    SnapshotLedger::Snapshot beginStreaming(std::vector<char>& bytes) {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        SnapshotLedger::Snapshot snapshot = ledger.snapshot();
+        size_t slots = snapshot.accountSlots();
+        shipped.assign(slots, 0);
+        for (size_t i = 0; i < slots; i++) {
+            shipped[i] = snapshot.historySize(i);
+        }
+
+        ReplicationCodec::fullState(bytes);
+        keys.forEach(time(nullptr), [&](const std::string& key, size_t request, bool result, time_t storedAt) {
+            ReplicationCodec::key(bytes, key, request, result, storedAt);
+        });
+
+        std::lock_guard<std::mutex> lock(mutex);
+        streaming = true;
+        status.connected = true;
+        status.lagging = false;
+        return snapshot;
+    }
+
+    // Sends every account visible in `snapshot`, with its history, without
+    // the writer lock
+    void sendFullState(const SnapshotLedger::Snapshot& snapshot, std::vector<char>& bytes) {
+        AccountRef account;
+        std::string password;
+        size_t slots = snapshot.accountSlots();
+        for (size_t i = 0; i < slots; i++) {
+            if (!snapshot.readAt(i, account)) {
+                continue;
+            }
+            snapshot.credential(account.accountNumber, password);
+            ReplicationCodec::account(bytes, account.accountNumber, account.type, account.creationDate,
+                                      *account.name, password);
+            for (const Transaction* t : account.transactions) {
+                ReplicationCodec::transaction(bytes, account.accountNumber, *t);
+            }
+            ReplicationCodec::balance(bytes, account);
+            if (bytes.size() >= FULL_STATE_PIECE) {
+                sendAll(bytes);
+                bytes.clear();
+            }
+        }
+        ReplicationCodec::commit(bytes, snapshot.sequence(), ReplicationCodec::nowNs());
+        sendAll(bytes);
+    }
+
+public:
+    ReplicationPrimary(const std::string& path, SnapshotLedger& snapshots, int firstAccount,
+                       IdempotencyCache& idempotency)
+        : socketPath(path), listenFd(-1), clientFd(-1), ledger(snapshots), firstAccountNumber(firstAccount),
+          keys(idempotency), streaming(false), stopping(false) {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Socket path too long");
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path.c_str());
+        if (listenFd < 0 || bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 1) != 0) {
+            if (listenFd >= 0) {
+                close(listenFd);
+            }
+            throw std::runtime_error("Cannot listen on " + path);
+        }
+    }
+
+    // Starts accepting replicas
+    void start() {
+        worker = std::thread(&ReplicationPrimary::run, this);
+    }
+
+    ReplicationPrimary(const ReplicationPrimary&) = delete;
+    ReplicationPrimary& operator=(const ReplicationPrimary&) = delete;
+
+    ~ReplicationPrimary() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            if (clientFd >= 0) {
+                shutdown(clientFd, SHUT_RDWR);
+            }
+        }
+        shutdown(listenFd, SHUT_RDWR);
+        ready.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+
+    // Writer lock held: ships an idempotency key stored by the commit in
+    // progress
+    void remembered(const std::string& key, size_t request, bool result, time_t storedAt) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!streaming) {
+                return;
+            }
+        }
+        ReplicationCodec::key(scratch, key, request, result, storedAt);
+    }
+
+    void onPublish(const Account& account) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!streaming) {
+                return;
+            }
+        }
+        size_t index = (size_t)(account.accountNumber - firstAccountNumber);
+        if (index >= shipped.size()) {
+            shipped.resize(index + 1, 0);
+            ReplicationCodec::account(scratch, account);
+        }
+        for (size_t i = shipped[index]; i < account.transactions.size(); i++) {
+            ReplicationCodec::transaction(scratch, account.accountNumber, account.transactions[i]);
+        }
+        shipped[index] = account.transactions.size();
+        ReplicationCodec::balance(scratch, account);
+    }
+
+    void onCommit(uint64_t seq) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            status.seq = seq;
+        }
+        if (scratch.empty()) {
+            return;
+        }
+        ReplicationCodec::commit(scratch, seq, ReplicationCodec::nowNs());
+        enqueue(scratch);
+        scratch.clear();
+    }
+
+    ReplicationStatus getStatus() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return status;
+    }
+};
+
+// Replica side: connects to a primary, decodes its stream and hands each
+// complete commit to `apply`, in order, from a background thread. If the
+// primary drops the connection (e.g. because this replica fell too far
+// behind) it reconnects and applies the full state the primary sends first;
+// `apply` must accept one that repeats accounts and transactions it already
+// has (ReplicatedBatch::fullState).
+class ReplicationReplica {
+private:
+    std::string socketPath;
+    int fd;                     // guarded by mutex; -1 between connections
+    std::function<void(const ReplicatedBatch&)> apply;
+    std::mutex mutex;
+    ReplicationStatus status;
+    std::atomic<bool> stopping;
+    std::thread worker;
+
+    static int connectTo(const std::string& path) {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Socket path too long");
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+
+        int s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s >= 0 && connect(s, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(s);
+            s = -1;
+        }
+        return s;
+    }
+
+    void run() {
+        follow();
+        while (!stopping) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                status.connected = false;
+                close(fd);
+                fd = -1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            int s = connectTo(socketPath);
+            if (s < 0) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                fd = s;
+                status.connected = true;
+                status.resyncs++;
+            }
+            if (stopping) {
+                break;
+            }
+            follow();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        status.connected = false;
+    }
+
+    // Applies commits from the current connection until it closes
+    void follow() {
+        std::vector<char> buffer;
+        size_t used = 0;
+        ReplicatedBatch batch;
+        buffer.resize(1 << 20);
+
+        while (!stopping) {
+            if (used == buffer.size()) {
+                buffer.resize(buffer.size() * 2);   // one record larger than the buffer
+            }
+            ssize_t n = recv(fd, buffer.data() + used, buffer.size() - used, 0);
+            if (n <= 0) {
+                break;
+            }
+            used += (size_t)n;
+
+            ReplicationCodec::Reader in{buffer.data(), buffer.data() + used};
+            bool committed;
+            uint64_t applied = 0;
+            try {
+                while (ReplicationCodec::decode(in, batch, committed)) {
+                    if (!committed) {
+                        continue;
+                    }
+                    apply(batch);
+                    applied = batch.seq;
+
+                    double lagMs = (ReplicationCodec::nowNs() - batch.primaryTimeNs) / 1e6;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    status.seq = batch.seq;
+                    status.lastLagMs = lagMs;
+                    status.maxLagMs = std::max(status.maxLagMs, lagMs);
+                    batch.clear();
+                }
+            } catch (const std::exception&) {
+                break;   // corrupt stream or a batch the replica cannot apply
+            }
+
+            size_t consumed = in.p - buffer.data();
+            std::memmove(buffer.data(), in.p, used - consumed);
+            used -= consumed;
+
+            if (applied != 0) {
+                send(fd, &applied, sizeof(applied), MSG_NOSIGNAL);
+            }
+        }
+    }
+
+public:
+    ReplicationReplica(const std::string& path, std::function<void(const ReplicatedBatch&)> applyBatch)
+        : socketPath(path), fd(-1), apply(applyBatch), stopping(false) {
+        fd = connectTo(path);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot connect to primary at " + path);
+        }
+        status.connected = true;
+        worker = std::thread(&ReplicationReplica::run, this);
+    }
+
+    ReplicationReplica(const ReplicationReplica&) = delete;
+    ReplicationReplica& operator=(const ReplicationReplica&) = delete;
+
+    ~ReplicationReplica() { stop(); }
+
+    // Stops following the primary. Commits already read from the socket are
+    // applied first; a partly received one is dropped. Returns once the
+    // applying thread has exited, so it is bounded by one read buffer of
+    // work.
+    void stop() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                if (fd >= 0) {
+                    shutdown(fd, SHUT_RDWR);
+                }
+            }
+            worker.join();
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    ReplicationStatus getStatus() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return status;
+    }
+};
+
+#else
+
+class ReplicationPrimary : public CommitListener {
+public:
+    ReplicationPrimary(const std::string&, SnapshotLedger&, int, IdempotencyCache&) {
+        throw std::runtime_error("Replication is not supported on this platform");
+    }
+    void start() {}
+    void remembered(const std::string&, size_t, bool, time_t) {}
+    void onPublish(const Account&) override {}
+    void onCommit(uint64_t) override {}
+    ReplicationStatus getStatus() { return ReplicationStatus(); }
+};
+
+class ReplicationReplica {
+public:
+    ReplicationReplica(const std::string&, std::function<void(const ReplicatedBatch&)>) {
+        throw std::runtime_error("Replication is not supported on this platform");
+    }
+    void stop() {}
+    ReplicationStatus getStatus() { return ReplicationStatus(); }
+};
+
+#endif
@@ -0,0 +1,475 @@
+#pragma once
+#include "Account.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sees everything a Commit publishes, in commit order, while the writer lock
+// is held.
+class CommitListener {
+public:
+    virtual void onPublish(const Account& account) = 0;
+    virtual void onCommit(uint64_t seq) = 0;
+    virtual ~CommitListener() {}
+};
+
+// Read-only, point-in-time copy of one account
+struct AccountView {
+    int accountNumber;
+    std::string name;
+    AccountType type;
+    Money balance;
+    time_t creationDate;
+    std::vector<Transaction> transactions;
+};
+
+// An account as a snapshot sees it, pointing into the snapshot's history
+// instead of copying it. Valid while the Snapshot it came from is alive.
+struct AccountRef {
+    int accountNumber;
+    const std::string* name;
+    AccountType type;
+    Money balance;
+    int32_t interestCarry;
+    int32_t lastAccrualDate;
+    time_t creationDate;
+    std::vector<const Transaction*> transactions;   // oldest first
+};
+
+// Multi-version store of account balances and histories for lock-free reads.
+//
+// Writers are serialized through a Commit, which stamps every version it
+// publishes with one sequence number and makes them visible together when it
+// ends. A reader pins the latest finished sequence in a reader slot and only
+// looks at versions stamped at or before it, so a statement (balance and
+// history) or a bank-wide total is always consistent and never waits for a
+// writer.
+//
+// Each account keeps a newest-first chain of balance versions. History is an
+// immutable newest-first list shared by all versions, so appending a
+// transaction never copies. When a writer publishes, it drops versions that
+// no pinned reader can reach any more.
+class SnapshotLedger {
+private:
+    struct HistoryNode {
+        Transaction tx;
+        const HistoryNode* prev;
+    };
+
+    struct Version {
+        uint64_t seq;
+        Money balance;
+        int32_t interestCarry;     // end-of-day state, kept with the balance it belongs to
+        int32_t lastAccrualDate;
+        size_t txCount;
+        const HistoryNode* history;
+        std::atomic<Version*> older;
+    };
+
+    struct Slot {
+        int accountNumber;
+        std::string name;
+        AccountType type;
+        time_t creationDate;
+        std::string password;   // stored hash; fixed at creation
+        std::atomic<Version*> head;
+        // Writer-only: how much of the account's history is mirrored, and
+        // the oldest pinned sequence at the last trim
+        const HistoryNode* lastHistory;
+        size_t mirrored;
+        uint64_t trimmedAt;
+    };
+
+    // Slots live in fixed-size segments that never move, so readers can
+    // index them while createAccount appends.
+    static const size_t SEGMENT_SIZE = 4096;
+    static const size_t MAX_SEGMENTS = 65536;
+    static const int MAX_READERS = 64;
+    static const uint64_t FREE = UINT64_MAX;
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> seq;
+    };
+
+    int firstAccountNumber;
+    std::atomic<Slot*>* segments;
+    std::atomic<size_t> slotCount;
+    std::atomic<uint64_t> stableSeq;
+    uint64_t nextSeq;
+    std::mutex writerMutex;
+    CommitListener* listener;
+    ReaderSlot readers[MAX_READERS];
+
+    Slot* slotAt(size_t index) const {
+        return &segments[index / SEGMENT_SIZE].load(std::memory_order_acquire)[index % SEGMENT_SIZE];
+    }
+
+    Slot* slotFor(int accountNumber) const {
+        long long index = (long long)accountNumber - firstAccountNumber;
+        if (index < 0 || (size_t)index >= slotCount.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return slotAt((size_t)index);
+    }
+
+    // Oldest sequence any reader may still be looking at
+    uint64_t oldestPinned() const {
+        uint64_t oldest = stableSeq.load();
+        for (const auto& reader : readers) {
+            uint64_t seq = reader.seq.load();
+            if (seq < oldest) {
+                oldest = seq;
+            }
+        }
+        return oldest;
+    }
+
+    static const Version* visible(const Slot* slot, uint64_t seq) {
+        const Version* v = slot->head.load(std::memory_order_acquire);
+        while (v != nullptr && v->seq > seq) {
+            v = v->older.load(std::memory_order_acquire);
+        }
+        return v;
+    }
+
+    // Keeps the newest version at or before `oldest` and everything newer;
+    // older versions are unreachable for every pinned reader. Versions added
+    // since the last trim are all newer than `oldest`, so while a reader
+    // stays pinned the chain is not walked again on every publish.
+    static void trim(Slot* slot, uint64_t oldest) {
+        if (slot->trimmedAt == oldest) {
+            return;
+        }
+        slot->trimmedAt = oldest;
+        Version* keep = slot->head.load(std::memory_order_relaxed);
+        while (keep != nullptr && keep->seq > oldest) {
+            keep = keep->older.load(std::memory_order_relaxed);
+        }
+        if (keep == nullptr) {
+            return;
+        }
+        Version* dead = keep->older.exchange(nullptr, std::memory_order_acq_rel);
+        while (dead != nullptr) {
+            Version* next = dead->older.load(std::memory_order_relaxed);
+            delete dead;
+            dead = next;
+        }
+    }
+
+    int pinReader() {
+        for (;;) {
+            for (int i = 0; i < MAX_READERS; i++) {
+                uint64_t expected = FREE;
+                uint64_t seq = stableSeq.load();
+                if (!readers[i].seq.compare_exchange_strong(expected, seq)) {
+                    continue;
+                }
+                // Re-check after publishing the pin: if a writer moved on in
+                // between, it may not have seen us, so pin the newer sequence.
+                uint64_t now = stableSeq.load();
+                while (now != seq) {
+                    seq = now;
+                    readers[i].seq.store(seq);
+                    now = stableSeq.load();
+                }
+                return i;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void unpinReader(int reader) {
+        readers[reader].seq.store(FREE, std::memory_order_release);
+    }
+
+    Slot* appendSlot(const Account& account) {
+        size_t index = slotCount.load(std::memory_order_relaxed);
+        if ((long long)account.accountNumber - firstAccountNumber != (long long)index) {
+            throw std::logic_error("Snapshot slots must follow account number order");
+        }
+        size_t segment = index / SEGMENT_SIZE;
+        if (segment >= MAX_SEGMENTS) {
+            throw std::length_error("Snapshot ledger is full");
+        }
+        if (index % SEGMENT_SIZE == 0) {
+            segments[segment].store(new Slot[SEGMENT_SIZE], std::memory_order_release);
+        }
+
+        Slot* slot = slotAt(index);
+        slot->accountNumber = account.accountNumber;
+        slot->name = account.name;
+        slot->type = account.type;
+        slot->creationDate = account.creationDate;
+        slot->password = account.password;
+        slot->head.store(nullptr, std::memory_order_relaxed);
+        slot->lastHistory = nullptr;
+        slot->mirrored = 0;
+        slot->trimmedAt = 0;
+        slotCount.store(index + 1, std::memory_order_release);
+        return slot;
+    }
+
+public:
+    // Writer handle. Holds the writer lock for its lifetime; everything it
+    // publishes becomes visible atomically when it is destroyed.
+    class Commit {
+    private:
+        SnapshotLedger& ledger;
+        std::unique_lock<std::mutex> lock;
+        uint64_t seq;
+        uint64_t oldest;
+        bool dirty;
+
+    public:
+        explicit Commit(SnapshotLedger& l)
+            : ledger(l), lock(l.writerMutex), seq(l.nextSeq), oldest(l.oldestPinned()), dirty(false) {}
+
+        Commit(const Commit&) = delete;
+        Commit& operator=(const Commit&) = delete;
+
+        ~Commit() {
+            if (dirty) {
+                if (ledger.listener != nullptr) {
+                    ledger.listener->onCommit(seq);
+                }
+                ledger.nextSeq++;
+                ledger.stableSeq.store(seq, std::memory_order_release);
+            }
+        }
+
+        // Publishes the account's current balance and any transactions
+        // appended since its last publish.
+        void publish(const Account& account) {
+            if (ledger.listener != nullptr) {
+                ledger.listener->onPublish(account);
+            }
+            Slot* slot = ledger.slotFor(account.accountNumber);
+            if (slot == nullptr) {
+                slot = ledger.appendSlot(account);
+            }
+
+            while (slot->mirrored < account.transactions.size()) {
+                slot->lastHistory = new HistoryNode{account.transactions[slot->mirrored], slot->lastHistory};
+                slot->mirrored++;
+            }
+
+            Version* head = slot->head.load(std::memory_order_relaxed);
+            if (head != nullptr && head->seq == seq) {
+                head->balance = account.balance;   // not visible yet
+                head->interestCarry = account.interestCarry;
+                head->lastAccrualDate = account.lastAccrualDate;
+                head->txCount = slot->mirrored;
+                head->history = slot->lastHistory;
+                return;
+            }
+
+            Version* v = new Version;
+            v->seq = seq;
+            v->balance = account.balance;
+            v->interestCarry = account.interestCarry;
+            v->lastAccrualDate = account.lastAccrualDate;
+            v->txCount = slot->mirrored;
+            v->history = slot->lastHistory;
+            v->older.store(head, std::memory_order_relaxed);
+            slot->head.store(v, std::memory_order_release);
+            dirty = true;
+
+            trim(slot, oldest);
+        }
+    };
+
+    // Reader handle pinned at one sequence number
+    class Snapshot {
+    private:
+        SnapshotLedger* ledger;
+        int reader;
+        uint64_t seq;
+
+    public:
+        explicit Snapshot(SnapshotLedger& l) : ledger(&l), reader(l.pinReader()) {
+            seq = l.readers[reader].seq.load();
+        }
+
+        Snapshot(Snapshot&& other) : ledger(other.ledger), reader(other.reader), seq(other.seq) {
+            other.ledger = nullptr;
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        ~Snapshot() {
+            if (ledger != nullptr) {
+                ledger->unpinReader(reader);
+            }
+        }
+
+        uint64_t sequence() const { return seq; }
+
+        bool find(int accountNumber, AccountView& view) const {
+            const Slot* slot = ledger->slotFor(accountNumber);
+            if (slot == nullptr) {
+                return false;
+            }
+            const Version* v = visible(slot, seq);
+            if (v == nullptr) {
+                return false;   // created after this snapshot
+            }
+
+            view.accountNumber = slot->accountNumber;
+            view.name = slot->name;
+            view.type = slot->type;
+            view.creationDate = slot->creationDate;
+            view.balance = v->balance;
+            view.transactions.resize(v->txCount);
+            const HistoryNode* node = v->history;
+            for (size_t i = v->txCount; i > 0; i--) {
+                view.transactions[i - 1] = node->tx;
+                node = node->prev;
+            }
+            return true;
+        }
+
+        // One transaction by its 1-based id within the account
+        bool transaction(int accountNumber, int transactionId, Transaction& out) const {
+            const Slot* slot = ledger->slotFor(accountNumber);
+            const Version* v = slot != nullptr ? visible(slot, seq) : nullptr;
+            if (v == nullptr || transactionId < 1 || (size_t)transactionId > v->txCount) {
+                return false;
+            }
+            const HistoryNode* node = v->history;
+            for (size_t i = v->txCount; i > (size_t)transactionId; i--) {
+                node = node->prev;
+            }
+            out = node->tx;
+            return true;
+        }
+
+        // Stored password hash, for login checks off the writer lock
+        bool credential(int accountNumber, std::string& stored) const {
+            const Slot* slot = ledger->slotFor(accountNumber);
+            if (slot == nullptr || visible(slot, seq) == nullptr) {
+                return false;
+            }
+            stored = slot->password;
+            return true;
+        }
+
+        // Indexes to pass to readAt(); includes accounts newer than the
+        // snapshot, which readAt() skips
+        size_t accountSlots() const {
+            return ledger->slotCount.load(std::memory_order_acquire);
+        }
+
+        // Transactions visible for the account at `index`, 0 if none
+        size_t historySize(size_t index) const {
+            const Version* v = visible(ledger->slotAt(index), seq);
+            return v != nullptr ? v->txCount : 0;
+        }
+
+        // The account at `index` (counted from the first account number)
+        // without copying its history; false if it was created after the
+        // snapshot. Bulk readers reuse `out` across accounts.
+        bool readAt(size_t index, AccountRef& out) const {
+            const Slot* slot = ledger->slotAt(index);
+            const Version* v = visible(slot, seq);
+            if (v == nullptr) {
+                return false;
+            }
+            out.accountNumber = slot->accountNumber;
+            out.name = &slot->name;
+            out.type = slot->type;
+            out.creationDate = slot->creationDate;
+            out.balance = v->balance;
+            out.interestCarry = v->interestCarry;
+            out.lastAccrualDate = v->lastAccrualDate;
+            out.transactions.resize(v->txCount);
+            const HistoryNode* node = v->history;
+            for (size_t i = v->txCount; i > 0; i--) {
+                out.transactions[i - 1] = &node->tx;
+                node = node->prev;
+            }
+            return true;
+        }
+
+        Money balance(int accountNumber) const {
+            const Slot* slot = ledger->slotFor(accountNumber);
+            const Version* v = slot != nullptr ? visible(slot, seq) : nullptr;
+            return v != nullptr ? v->balance : 0;
+        }
+
+        size_t accountCount() const {
+            size_t count = 0;
+            size_t slots = ledger->slotCount.load(std::memory_order_acquire);
+            for (size_t i = 0; i < slots; i++) {
+                if (visible(ledger->slotAt(i), seq) != nullptr) {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        Money totalBalance() const {
+            Money total = 0;
+            size_t slots = ledger->slotCount.load(std::memory_order_acquire);
+            for (size_t i = 0; i < slots; i++) {
+                const Version* v = visible(ledger->slotAt(i), seq);
+                if (v != nullptr) {
+                    total += v->balance;
+                }
+            }
+            return total;
+        }
+    };
+
+    explicit SnapshotLedger(int firstAccount)
+        : firstAccountNumber(firstAccount), segments(new std::atomic<Slot*>[MAX_SEGMENTS]),
+          slotCount(0), stableSeq(0), nextSeq(1), listener(nullptr) {
+        for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+            segments[i].store(nullptr, std::memory_order_relaxed);
+        }
+        for (auto& reader : readers) {
+            reader.seq.store(FREE, std::memory_order_relaxed);
+        }
+    }
+
+    SnapshotLedger(const SnapshotLedger&) = delete;
+    SnapshotLedger& operator=(const SnapshotLedger&) = delete;
+
+    ~SnapshotLedger() {
+        size_t slots = slotCount.load();
+        for (size_t i = 0; i < slots; i++) {
+            Slot* slot = slotAt(i);
+            Version* v = slot->head.load();
+            while (v != nullptr) {
+                Version* next = v->older.load();
+                delete v;
+                v = next;
+            }
+            const HistoryNode* node = slot->lastHistory;
+            while (node != nullptr) {
+                const HistoryNode* prev = node->prev;
+                delete node;
+                node = prev;
+            }
+        }
+        for (size_t i = 0; i * SEGMENT_SIZE < slots; i++) {
+            delete[] segments[i].load();
+        }
+        delete[] segments;
+    }
+
+    Commit beginCommit() { return Commit(*this); }
+
+    // Installs (or clears, with nullptr) the listener for future commits
+    void setCommitListener(CommitListener* l) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        listener = l;
+    }
+
+    Snapshot snapshot() { return Snapshot(*this); }
+};
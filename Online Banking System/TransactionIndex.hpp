@@ -0,0 +1,337 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where an indexed transaction lives: account number plus its 1-based
+// Transaction::id within that account.
+struct TransactionRef {
+    int accountNumber;
+    int transactionId;
+};
+
+// Inverted index from description words to transactions across all accounts.
+//
+// Every indexed transaction gets a sequential document id. Each word maps to
+// a posting list of document ids stored as varint-encoded deltas, and the
+// dictionary is ordered so prefix queries are a range scan. Queries walk
+// the posting lists lazily and stop decoding once they have `limit` results.
+// Callers only queue descriptions; a background thread tokenizes and
+// indexes them in batches, so deposits and transfers do not wait on the
+// index unless the queue is full, which holds them until the indexer
+// catches up instead of letting the queue grow without bound.
+class TransactionIndex {
+private:
+    struct PostingList {
+        std::vector<uint8_t> bytes;
+        uint32_t last = 0;
+        uint32_t count = 0;
+
+        void add(uint32_t doc) {
+            if (count > 0 && doc == last) {
+                return;   // word repeated in the same description
+            }
+            uint32_t delta = count == 0 ? doc : doc - last;
+            while (delta >= 0x80) {
+                bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+                delta >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(delta));
+            last = doc;
+            count++;
+        }
+
+    };
+
+    // Decodes one posting list a document at a time
+    struct Cursor {
+        const PostingList* list;
+        size_t pos;
+        uint32_t doc;
+
+        explicit Cursor(const PostingList& l) : list(&l), pos(0), doc(0) {}
+
+        bool next() {
+            if (pos >= list->bytes.size()) {
+                return false;
+            }
+            uint32_t delta = 0;
+            int shift = 0;
+            uint8_t b;
+            do {
+                b = list->bytes[pos++];
+                delta |= static_cast<uint32_t>(b & 0x7f) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            doc += delta;
+            return true;
+        }
+    };
+
+    // Ascending, de-duplicated documents for one query word: a merge of
+    // the cursors of every term it matches (one, unless it is a prefix).
+    class WordStream {
+    private:
+        std::vector<Cursor> heap;   // min-heap on the cursor's current doc
+        uint32_t doc = 0;
+        bool live = false;
+
+        static bool later(const Cursor& a, const Cursor& b) { return a.doc > b.doc; }
+
+    public:
+        void addTerm(const PostingList& list) {
+            Cursor c(list);
+            if (c.next()) {
+                heap.push_back(c);
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+
+        // Moves to the next document after the current one
+        bool advance() {
+            bool started = live;
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                Cursor& c = heap.back();
+                uint32_t found = c.doc;
+                if (c.next()) {
+                    std::push_heap(heap.begin(), heap.end(), later);
+                } else {
+                    heap.pop_back();
+                }
+                if (!started || found != doc) {
+                    doc = found;
+                    live = true;
+                    return true;
+                }
+            }
+            live = false;
+            return false;
+        }
+
+        // Moves to the first document at or after `target`
+        bool seek(uint32_t target) {
+            while (live && doc < target) {
+                advance();
+            }
+            return live;
+        }
+
+        bool valid() const { return live; }
+        uint32_t current() const { return doc; }
+    };
+
+    struct Pending {
+        TransactionRef ref;
+        std::string description;
+    };
+
+    std::map<std::string, PostingList> terms;
+    std::vector<TransactionRef> documents;
+    mutable std::shared_mutex indexMutex;
+
+    std::vector<Pending> queue;
+    size_t queueLimit;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::condition_variable queueSpace;
+    std::condition_variable queueDrained;
+    bool indexing;
+    bool stopping;
+    std::thread worker;
+
+    template <typename F>
+    static void forEachToken(const std::string& text, F f) {
+        std::string token;
+        for (char c : text) {
+            if (std::isalnum(static_cast<unsigned char>(c))) {
+                token += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            } else if (!token.empty()) {
+                f(token);
+                token.clear();
+            }
+        }
+        if (!token.empty()) {
+            f(token);
+        }
+    }
+
+    void indexBatch(const std::vector<Pending>& batch) {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        for (const auto& p : batch) {
+            uint32_t doc = static_cast<uint32_t>(documents.size());
+            documents.push_back(p.ref);
+            forEachToken(p.description, [&](const std::string& token) {
+                terms[token].add(doc);
+            });
+        }
+    }
+
+    void run() {
+        std::vector<Pending> batch;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        for (;;) {
+            queueReady.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            batch.swap(queue);
+            indexing = true;
+            lock.unlock();
+            queueSpace.notify_all();
+
+            indexBatch(batch);
+            batch.clear();
+
+            lock.lock();
+            indexing = false;
+            if (queue.empty()) {
+                queueDrained.notify_all();
+            }
+        }
+    }
+
+    void openWord(const std::string& word, bool prefix, WordStream& stream) const {
+        if (!prefix) {
+            auto it = terms.find(word);
+            if (it != terms.end()) {
+                stream.addTerm(it->second);
+            }
+        } else {
+            for (auto it = terms.lower_bound(word);
+                 it != terms.end() && it->first.compare(0, word.size(), word) == 0; ++it) {
+                stream.addTerm(it->second);
+            }
+        }
+        stream.advance();
+    }
+
+public:
+    // At most `maxQueued` descriptions wait for the indexer; add() blocks
+    // beyond that.
+    explicit TransactionIndex(size_t maxQueued = 1 << 20)
+        : queueLimit(maxQueued == 0 ? 1 : maxQueued), indexing(false), stopping(false) {
+        worker = std::thread(&TransactionIndex::run, this);
+    }
+
+    TransactionIndex(const TransactionIndex&) = delete;
+    TransactionIndex& operator=(const TransactionIndex&) = delete;
+
+    ~TransactionIndex() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_one();
+        worker.join();
+    }
+
+    // Queues a transaction for indexing; only copies the description.
+    // Waits while the queue is full.
+    void add(int accountNumber, int transactionId, const std::string& description) {
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueSpace.wait(lock, [&] { return queue.size() < queueLimit; });
+            wake = queue.empty();
+            queue.push_back(Pending{{accountNumber, transactionId}, description});
+        }
+        if (wake) {
+            queueReady.notify_one();
+        }
+    }
+
+    // Indexes many transactions in one pass under the index lock instead of
+    // queueing them one by one, for bulk loads. `forEach(add)` must call
+    // add(accountNumber, transactionId, description) once per transaction.
+    // Whatever was queued before is indexed first.
+    template <typename ForEach>
+    void addAll(ForEach forEach) {
+        flush();
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        forEach([&](int accountNumber, int transactionId, const std::string& description) {
+            uint32_t doc = static_cast<uint32_t>(documents.size());
+            documents.push_back(TransactionRef{accountNumber, transactionId});
+            forEachToken(description, [&](const std::string& token) {
+                terms[token].add(doc);
+            });
+        });
+    }
+
+    // Blocks until everything queued so far is searchable.
+    void flush() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueDrained.wait(lock, [&] { return queue.empty() && !indexing; });
+    }
+
+    // Transactions whose description contains every word of the query.
+    // A word ending in '*' matches any word starting with it. Results are
+    // in indexing order, capped at `limit`.
+    std::vector<TransactionRef> search(const std::string& query, size_t limit = 100) const {
+        std::vector<std::pair<std::string, bool>> words;
+        std::string word;
+        auto flushWord = [&](bool prefix) {
+            if (!word.empty()) {
+                words.emplace_back(word, prefix);
+                word.clear();
+            }
+        };
+        for (char c : query) {
+            if (std::isalnum(static_cast<unsigned char>(c))) {
+                word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            } else {
+                flushWord(c == '*');
+            }
+        }
+        flushWord(false);
+
+        std::vector<TransactionRef> results;
+        if (words.empty()) {
+            return results;
+        }
+
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        std::vector<WordStream> streams(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            openWord(words[i].first, words[i].second, streams[i]);
+            if (!streams[i].valid()) {
+                return results;
+            }
+        }
+
+        // Leapfrog intersection: move every word up to the highest current
+        // document until they agree
+        while (results.size() < limit) {
+            uint32_t high = 0;
+            for (const auto& stream : streams) {
+                high = std::max(high, stream.current());
+            }
+            bool agreed = true;
+            for (auto& stream : streams) {
+                if (!stream.seek(high)) {
+                    return results;
+                }
+                agreed = agreed && stream.current() == high;
+            }
+            if (agreed) {
+                results.push_back(documents[high]);
+                if (!streams[0].advance()) {
+                    break;
+                }
+            }
+        }
+        return results;
+    }
+
+    size_t documentCount() const {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        return documents.size();
+    }
+};
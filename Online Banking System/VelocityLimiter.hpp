@@ -0,0 +1,90 @@
+#pragma once
+#include "Account.hpp"
+#include "AccountPolicy.hpp"
+#include "../Common/SlidingWindow.hpp"
+#include <array>
+#include <ctime>
+#include <unordered_map>
+
+// Per-account-type velocity limits. A negative value disables that limit.
+struct VelocityLimits {
+    long long maxWithdrawalsPerDay;
+    Money maxWithdrawalAmountPerDay;
+    long long maxTransfersPerMinute;
+};
+
+// Checks withdraw/transfer rates against sliding windows kept per account.
+// Only accounts that have moved money get an entry, and each entry is a
+// fixed-size pair of windows. Limits start from each account policy's
+// defaults and are kept per policy; an account type with no policy is
+// refused, as by the debit rules.
+class VelocityLimiter {
+private:
+    struct AccountWindows {
+        SlidingWindow<24, 3600> withdrawals;   // last 24h in 1h buckets
+        SlidingWindow<12, 5> transfers;        // last minute in 5s buckets
+    };
+
+    std::unordered_map<int, AccountWindows> windows;
+    std::array<VelocityLimits, PolicyCount<AccountPolicies>::value> limits;
+
+    template <typename Policy>
+    static VelocityLimits defaultLimits() {
+        return {Policy::maxWithdrawalsPerDay, Policy::maxWithdrawalAmountPerDay, Policy::maxTransfersPerMinute};
+    }
+
+    template <typename... Policies>
+    void resetLimits(PolicyList<Policies...>) {
+        limits = {{defaultLimits<Policies>()...}};
+    }
+
+    template <typename Policy>
+    VelocityLimits& limitsOf(Policy) {
+        return limits[PolicyIndex<Policy, AccountPolicies>::value];
+    }
+
+    template <typename Policy>
+    const VelocityLimits& limitsOf(Policy) const {
+        return limits[PolicyIndex<Policy, AccountPolicies>::value];
+    }
+
+public:
+    VelocityLimiter() {
+        resetLimits(AccountPolicies());
+    }
+
+    void setLimits(AccountType type, const VelocityLimits& newLimits) {
+        withAccountPolicy(type, [&](auto policy) {
+            limitsOf(policy) = newLimits;
+            return true;
+        });
+    }
+
+    // All zero for a type with no policy
+    VelocityLimits getLimits(AccountType type) const {
+        return withAccountPolicy(type, [&](auto policy) { return limitsOf(policy); });
+    }
+
+    bool allowWithdrawal(const Account& account, Money amount, time_t now) {
+        return withAccountPolicy(account.type, [&](auto policy) {
+            const VelocityLimits& l = limitsOf(policy);
+            return windows[account.accountNumber].withdrawals.allows(
+                now, amount, l.maxWithdrawalsPerDay, l.maxWithdrawalAmountPerDay);
+        });
+    }
+
+    void recordWithdrawal(const Account& account, Money amount, time_t now) {
+        windows[account.accountNumber].withdrawals.record(now, amount);
+    }
+
+    bool allowTransfer(const Account& account, time_t now) {
+        return withAccountPolicy(account.type, [&](auto policy) {
+            return windows[account.accountNumber].transfers.allows(
+                now, 0, limitsOf(policy).maxTransfersPerMinute, -1);
+        });
+    }
+
+    void recordTransfer(const Account& account, Money amount, time_t now) {
+        windows[account.accountNumber].transfers.record(now, amount);
+    }
+};
@@ -1,396 +1,1108 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <ctime>
-#include <iomanip>
-#include <limits>
-#include <cstdlib> // For system("cls") or system("clear")
-
-using namespace std;
-
-// Cross-platform screen clearing function
-void clearScreen() {
-    #ifdef _WIN32
-    system("cls");
-    #else
-    system("clear");
-    #endif
-}
-
-// Account types
-enum AccountType { SAVINGS = 1, CURRENT };
-
-// Transaction structure
-struct Transaction {
-    int id;
-    string type;
-    double amount;
-    time_t timestamp;
-    int fromAccount;
-    int toAccount;
-    string description;
-};
-
-// Account structure
-struct Account {
-    int accountNumber;
-    string name;
-    AccountType type;
-    double balance;
-    string password;
-    time_t creationDate;
-    vector<Transaction> transactions;
-};
-
-class OnlineBankingSystem {
-private:
-    vector<Account> accounts;
-    int nextAccountNumber;
-    
-    Account* findAccount(int accountNumber) {
-        for (auto &account : accounts) {
-            if (account.accountNumber == accountNumber) {
-                return &account;
-            }
-        }
-        return nullptr;
-    }
-    
-    void clearInputBuffer() {
-        cin.clear();
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-    }
-    
-    string formatTime(time_t time) {
-        char buffer[80];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&time));
-        return string(buffer);
-    }
-
-public:
-    OnlineBankingSystem() : nextAccountNumber(1000) {}
-    
-    int createAccount(string name, AccountType type, string password) {
-        Account newAccount;
-        newAccount.accountNumber = nextAccountNumber++;
-        newAccount.name = name;
-        newAccount.type = type;
-        newAccount.balance = 0.0;
-        newAccount.password = password;
-        newAccount.creationDate = time(nullptr);
-        
-        accounts.push_back(newAccount);
-        return newAccount.accountNumber;
-    }
-    
-    bool deposit(int accountNumber, double amount, string description) {
-        Account* account = findAccount(accountNumber);
-        if (account != nullptr && amount > 0) {
-            account->balance += amount;
-            
-            Transaction t;
-            t.id = account->transactions.size() + 1;
-            t.type = "DEPOSIT";
-            t.amount = amount;
-            t.timestamp = time(nullptr);
-            t.fromAccount = -1;
-            t.toAccount = accountNumber;
-            t.description = description;
-            
-            account->transactions.push_back(t);
-            return true;
-        }
-        return false;
-    }
-    
-    bool withdraw(int accountNumber, double amount, string description) {
-        Account* account = findAccount(accountNumber);
-        if (account != nullptr && amount > 0 && account->balance >= amount) {
-            account->balance -= amount;
-            
-            Transaction t;
-            t.id = account->transactions.size() + 1;
-            t.type = "WITHDRAWAL";
-            t.amount = amount;
-            t.timestamp = time(nullptr);
-            t.fromAccount = accountNumber;
-            t.toAccount = -1;
-            t.description = description;
-            
-            account->transactions.push_back(t);
-            return true;
-        }
-        return false;
-    }
-    
-    bool transfer(int fromAccount, int toAccount, double amount, string description) {
-        Account* sender = findAccount(fromAccount);
-        Account* receiver = findAccount(toAccount);
-        
-        if (sender != nullptr && receiver != nullptr && 
-            sender != receiver && amount > 0 && sender->balance >= amount) {
-            
-            sender->balance -= amount;
-            receiver->balance += amount;
-            
-            Transaction t1;
-            t1.id = sender->transactions.size() + 1;
-            t1.type = "TRANSFER_OUT";
-            t1.amount = amount;
-            t1.timestamp = time(nullptr);
-            t1.fromAccount = fromAccount;
-            t1.toAccount = toAccount;
-            t1.description = description;
-            sender->transactions.push_back(t1);
-            
-            Transaction t2;
-            t2.id = receiver->transactions.size() + 1;
-            t2.type = "TRANSFER_IN";
-            t2.amount = amount;
-            t2.timestamp = time(nullptr);
-            t2.fromAccount = fromAccount;
-            t2.toAccount = toAccount;
-            t2.description = description;
-            receiver->transactions.push_back(t2);
-            
-            return true;
-        }
-        return false;
-    }
-    
-    void viewAccount(int accountNumber) {
-        Account* account = findAccount(accountNumber);
-        if (account != nullptr) {
-            cout << "\n----------------------------------------\n";
-            cout << "          ACCOUNT STATEMENT\n";
-            cout << "----------------------------------------\n";
-            cout << left << setw(20) << "Account Number:" << account->accountNumber << endl;
-            cout << setw(20) << "Account Holder:" << account->name << endl;
-            cout << setw(20) << "Account Type:" << (account->type == SAVINGS ? "Savings" : "Current") << endl;
-            cout << setw(20) << "Balance:" << fixed << setprecision(2) << account->balance << " $" << endl;
-            cout << setw(20) << "Creation Date:" << formatTime(account->creationDate) << endl;
-            cout << "----------------------------------------\n";
-            
-            if (!account->transactions.empty()) {
-                cout << "\nTRANSACTION HISTORY:\n";
-                cout << left << setw(8) << "ID" << setw(15) << "Type" 
-                     << setw(12) << "Amount" << setw(22) << "Date/Time" 
-                     << setw(12) << "From" << setw(12) << "To" << "Description\n";
-                cout << "------------------------------------------------------------\n";
-                
-                for (const auto& t : account->transactions) {
-                    cout << setw(8) << t.id << setw(15) << t.type 
-                         << setw(12) << fixed << setprecision(2) << t.amount
-                         << setw(22) << formatTime(t.timestamp)
-                         << setw(12) << (t.fromAccount == -1 ? "N/A" : to_string(t.fromAccount))
-                         << setw(12) << (t.toAccount == -1 ? "N/A" : to_string(t.toAccount))
-                         << t.description << endl;
-                }
-                cout << "----------------------------------------\n";
-            } else {
-                cout << "\nNo transactions found for this account.\n";
-            }
-        } else {
-            cout << "\nError: Account not found!\n";
-        }
-    }
-};
-
-void displayMainMenu() {
-    clearScreen();
-    cout << "------------------------------------------\n";
-    cout << "       ONLINE BANKING SYSTEM - MENU\n";
-    cout << "------------------------------------------\n";
-    cout << "1. Create New Account\n";
-    cout << "2. Deposit Money\n";
-    cout << "3. Withdraw Money\n";
-    cout << "4. Transfer Money\n";
-    cout << "5. View Account Statement\n";
-    cout << "6. Exit\n";
-    cout << "----------------------------------------\n";
-    cout << "Enter your choice (1-6): ";
-}
-
-void createAccountUI(OnlineBankingSystem& bank) {
-    clearScreen();
-    string name, password;
-    int type;
-    
-    cout << "----------------------------------------\n";
-    cout << "          CREATE NEW ACCOUNT\n";
-    cout << "----------------------------------------\n";
-    
-    cout << "Enter your full name: ";
-    cin.ignore();
-    getline(cin, name);
-    
-    cout << "Enter password: ";
-    cin >> password;
-    
-    cout << "Select account type:\n";
-    cout << "1. Savings Account\n";
-    cout << "2. Current Account\n";
-    cout << "Enter choice (1-2): ";
-    cin >> type;
-    
-    while (type < 1 || type > 2) {
-        cout << "Invalid choice. Please enter 1 or 2: ";
-        cin >> type;
-    }
-    
-    int accNum = bank.createAccount(name, static_cast<AccountType>(type), password);
-    cout << "\nAccount created successfully!\n";
-    cout << "Your account number is: " << accNum << endl;
-}
-
-void depositUI(OnlineBankingSystem& bank) {
-    clearScreen();
-    int accountNumber;
-    double amount;
-    string description;
-    
-    cout << "----------------------------------------\n";
-    cout << "              DEPOSIT MONEY\n";
-    cout << "----------------------------------------\n";
-    
-    cout << "Enter account number: ";
-    cin >> accountNumber;
-    
-    cout << "Enter amount to deposit: $";
-    cin >> amount;
-    
-    cout << "Enter description: ";
-    cin.ignore();
-    getline(cin, description);
-    
-    if (bank.deposit(accountNumber, amount, description)) {
-        cout << "\nDeposit successful!\n";
-    } else {
-        cout << "\nDeposit failed. Invalid account or amount.\n";
-    }
-}
-
-void withdrawUI(OnlineBankingSystem& bank) {
-    clearScreen();
-    int accountNumber;
-    double amount;
-    string description;
-    
-    cout << "----------------------------------------\n";
-    cout << "             WITHDRAW MONEY\n";
-    cout << "----------------------------------------\n";
-    
-    cout << "Enter account number: ";
-    cin >> accountNumber;
-    
-    cout << "Enter amount to withdraw: $";
-    cin >> amount;
-    
-    cout << "Enter description: ";
-    cin.ignore();
-    getline(cin, description);
-    
-    if (bank.withdraw(accountNumber, amount, description)) {
-        cout << "\nWithdrawal successful!\n";
-    } else {
-        cout << "\nWithdrawal failed. Invalid account, amount or insufficient funds.\n";
-    }
-}
-
-void transferUI(OnlineBankingSystem& bank) {
-    clearScreen();
-    int fromAccount, toAccount;
-    double amount;
-    string description;
-    
-    cout << "----------------------------------------\n";
-    cout << "             TRANSFER MONEY\n";
-    cout << "----------------------------------------\n";
-    
-    cout << "Enter your account number: ";
-    cin >> fromAccount;
-    
-    cout << "Enter recipient account number: ";
-    cin >> toAccount;
-    
-    cout << "Enter amount to transfer: $";
-    cin >> amount;
-    
-    cout << "Enter description: ";
-    cin.ignore();
-    getline(cin, description);
-    
-    if (bank.transfer(fromAccount, toAccount, amount, description)) {
-        cout << "\nTransfer successful!\n";
-    } else {
-        cout << "\nTransfer failed. Check account numbers and balance.\n";
-    }
-}
-
-void viewAccountUI(OnlineBankingSystem& bank) {
-    clearScreen();
-    int accountNumber;
-    
-    cout << "----------------------------------------\n";
-    cout << "          VIEW ACCOUNT STATEMENT\n";
-    cout << "----------------------------------------\n";
-    
-    cout << "Enter account number: ";
-    cin >> accountNumber;
-    
-    bank.viewAccount(accountNumber);
-}
-
-void pauseScreen() {
-    cout << "\nPress Enter to continue...";
-    cin.ignore();
-    cin.get();
-}
-
-int main() {
-    OnlineBankingSystem bank;
-    int choice;
-    
-    do {
-        displayMainMenu();
-        
-        while (!(cin >> choice)) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            cout << "Invalid input. Please enter a number (1-6): ";
-        }
-        
-        switch(choice) {
-            case 1:
-                createAccountUI(bank);
-                pauseScreen();
-                break;
-            case 2:
-                depositUI(bank);
-                pauseScreen();
-                break;
-            case 3:
-                withdrawUI(bank);
-                pauseScreen();
-                break;
-            case 4:
-                transferUI(bank);
-                pauseScreen();
-                break;
-            case 5:
-                viewAccountUI(bank);
-                pauseScreen();
-                break;
-            case 6:
-                clearScreen();
-                cout << "\nThank you for using our banking system!\n";
-                break;
-            default:
-                cout << "Invalid choice. Please enter a number between 1 and 6.\n";
-                pauseScreen();
-        }
-        
-    } while (choice != 6);
-    
-    return 0;
+#include <iostream>
+#include <vector>
+#include <string>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <cstdlib> // For system("cls") or system("clear")
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <stdexcept>
+#include "Account.hpp"
+#include "EndOfDay.hpp"
+#include "VelocityLimiter.hpp"
+#include "Snapshot.hpp"
+#include "IdempotencyCache.hpp"
+#include "TransactionIndex.hpp"
+#include "LedgerExport.hpp"
+#include "BulkImport.hpp"
+#include "AccountPolicy.hpp"
+#include "Replication.hpp"
+#include "LedgerAudit.hpp"
+#include "HotAccount.hpp"
+#include "../Common/Credentials.hpp"
+#include "../Common/LockoutTable.hpp"
+#include "../Common/Trace.hpp"
+
+using namespace std;
+
+// Cross-platform screen clearing function
+void clearScreen() {
+    #ifdef _WIN32
+    system("cls");
+    #else
+    system("clear");
+    #endif
+}
+
+class OnlineBankingSystem {
+private:
+    vector<Account> accounts;
+    int nextAccountNumber;
+    VelocityLimiter velocity;
+    SnapshotLedger snapshots;
+    IdempotencyCache idempotency;
+    TransactionIndex searchIndex;
+    LockoutTable lockouts;   // failed logins per account number
+    HotAccountTable hotAccounts;   // accounts whose deposits skip the writer lock
+    // Declared last so their threads stop before the ledger goes away
+    unique_ptr<ReplicationPrimary> replicationPrimary;
+    unique_ptr<ReplicationReplica> replicationReplica;
+    
+    static const int FIRST_ACCOUNT_NUMBER = 1000;
+    
+    // Account numbers are handed out consecutively, so the number is the
+    // position in the store.
+    Account* findAccount(int accountNumber) {
+        long long index = (long long)accountNumber - FIRST_ACCOUNT_NUMBER;
+        if (index < 0 || index >= (long long)accounts.size()) {
+            return nullptr;
+        }
+        return &accounts[index];
+    }
+    
+    // What a keyed request asked for, so a key cannot be replayed for
+    // another amount, account or description
+    static size_t requestHash(int fromAccount, int toAccount, Money amount, const string& description) {
+        return hash<string>()(to_string(fromAccount) + "|" + to_string(toAccount) + "|" + to_string(amount) + "|" +
+                              description);
+    }
+    
+    // Result of an earlier call made with the same idempotency key, if any.
+    // Throws if the key was first used for a different request.
+    bool findReplay(const string& key, size_t request, bool& result) {
+        if (key.empty()) {
+            return false;
+        }
+        IdempotencyLookup found = idempotency.lookup(key, request, result, time(nullptr));
+        if (found == IDEMPOTENCY_MISMATCH) {
+            throw invalid_argument("Idempotency key was already used for a different request");
+        }
+        return found == IDEMPOTENCY_HIT;
+    }
+    
+    // Only requests that moved money are remembered. A rejected one (unknown
+    // account, bad amount, insufficient funds, a limit) may succeed when the
+    // client retries after fixing the cause, so it must run again.
+    bool remember(const string& key, size_t request) {
+        if (!key.empty()) {
+            time_t now = time(nullptr);
+            idempotency.insert(key, request, true, now);
+            if (replicationPrimary) {
+                replicationPrimary->remembered(key, request, true, now);
+            }
+        }
+        return true;
+    }
+    
+    // Records a fee already included in a debit
+    void recordFee(Account& account, Money fee, const string& description) {
+        Transaction t;
+        t.id = account.transactions.size() + 1;
+        t.type = "FEE";
+        t.amount = fee;
+        t.timestamp = time(nullptr);
+        t.fromAccount = account.accountNumber;
+        t.toAccount = -1;
+        t.description = description;
+        account.transactions.push_back(t);
+    }
+    
+    // Folds a hot account's queued credits into its balance and history.
+    // Writer lock held.
+    void settleHot(SnapshotLedger::Commit& commit, HotAccount& hot) {
+        Account* account = findAccount(hot.number());
+        size_t first = account->transactions.size();
+        if (hot.settle(*account) > 0) {
+            for (size_t i = first; i < account->transactions.size(); i++) {
+                searchIndex.add(account->accountNumber, account->transactions[i].id, account->transactions[i].description);
+            }
+            commit.publish(*account);
+        }
+    }
+    
+    void settleAllHot(SnapshotLedger::Commit& commit) {
+        hotAccounts.forEach([&](HotAccount& hot) { settleHot(commit, hot); });
+    }
+    
+    // Settles `account` if it is hot and has credits queued; true if the
+    // balance grew. Debits call this only when the settled balance does not
+    // cover them, so a hot account is never overdrawn while credits wait.
+    bool borrowPending(SnapshotLedger::Commit& commit, const Account& account) {
+        HotAccount* hot = hotAccounts.find(account.accountNumber);
+        if (hot == nullptr) {
+            return false;
+        }
+        Money before = account.balance;
+        settleHot(commit, *hot);
+        return account.balance != before;
+    }
+    
+    // Applies one primary commit on a replica, as a single local commit,
+    // idempotency keys included. A full state (sent again after a reconnect)
+    // skips the accounts and transactions this replica already has; both
+    // only ever grow.
+    void applyReplicated(const ReplicatedBatch& batch) {
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        vector<int> touched;
+        
+        for (const auto& account : batch.accounts) {
+            if (batch.fullState && account.accountNumber < nextAccountNumber) {
+                continue;
+            }
+            if (account.accountNumber != nextAccountNumber) {
+                throw logic_error("Replicated account out of order");
+            }
+            accounts.push_back(account);
+            nextAccountNumber++;
+            touched.push_back(account.accountNumber);
+        }
+        for (const auto& entry : batch.transactions) {
+            Account* account = findAccount(entry.first);
+            if (account == nullptr) {
+                throw logic_error("Replicated transaction for unknown account");
+            }
+            if (batch.fullState && entry.second.id <= (int)account->transactions.size()) {
+                continue;
+            }
+            account->transactions.push_back(entry.second);
+            searchIndex.add(entry.first, entry.second.id, entry.second.description);
+            touched.push_back(entry.first);
+        }
+        for (const auto& entry : batch.balances) {
+            Account* account = findAccount(entry.accountNumber);
+            if (account == nullptr) {
+                throw logic_error("Replicated balance for unknown account");
+            }
+            account->balance = entry.balance;
+            account->interestCarry = entry.interestCarry;
+            account->lastAccrualDate = entry.lastAccrualDate;
+            touched.push_back(entry.accountNumber);
+        }
+        for (const auto& entry : batch.keys) {
+            idempotency.insert(entry.key, (size_t)entry.request, entry.result, (time_t)entry.storedAt);
+        }
+        
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+        for (int accountNumber : touched) {
+            commit.publish(*findAccount(accountNumber));
+        }
+    }
+    
+    void clearInputBuffer() {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    
+    string formatTime(time_t time) {
+        char buffer[80];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&time));
+        return string(buffer);
+    }
+
+public:
+    OnlineBankingSystem() : nextAccountNumber(FIRST_ACCOUNT_NUMBER), snapshots(FIRST_ACCOUNT_NUMBER) {}
+    
+    int createAccount(string name, AccountType type, string password) {
+        string stored = hashCredential(password);   // slow by design; done before taking the lock
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        Account newAccount;
+        newAccount.accountNumber = nextAccountNumber++;
+        newAccount.name = name;
+        newAccount.type = type;
+        newAccount.balance = 0;
+        newAccount.password = stored;
+        newAccount.creationDate = time(nullptr);
+        
+        accounts.push_back(newAccount);
+        commit.publish(accounts.back());
+        return newAccount.accountNumber;
+    }
+    
+    // Checks a password on the shared credential pool without blocking
+    // writers: the stored hash comes from a snapshot. Each attempt counts
+    // against the account's lockout as soon as it is queued and is cleared if
+    // the password was right, so checks in flight count too; a locked account
+    // throws. An unknown account number is simply false and counts nothing.
+    future<bool> verifyPassword(int accountNumber, const string& password) {
+        string stored;
+        if (!snapshots.snapshot().credential(accountNumber, stored)) {
+            promise<bool> unknown;
+            unknown.set_value(false);
+            return unknown.get_future();
+        }
+        string key = to_string(accountNumber);
+        if (!lockouts.beginAttempt(key, time(nullptr))) {
+            throw runtime_error("Account locked after too many failed logins. Try again later.");
+        }
+        LockoutTable& table = lockouts;
+        try {
+            return CredentialVerifier::shared().verify(password, stored, [&table, key](bool ok) {
+                if (ok) {
+                    table.recordSuccess(key);
+                }
+            });
+        } catch (...) {
+            lockouts.cancelAttempt(key);
+            throw;
+        }
+    }
+    
+    // A retry carrying the same non-empty idempotency key as a request that
+    // succeeded returns true without moving money again; a key whose request
+    // was rejected is not kept, so its retry runs again. Reusing a key with
+    // other parameters throws invalid_argument.
+    bool deposit(int accountNumber, Money amount, string description, const string& idempotencyKey = "") {
+        TRACE_SCOPE("OnlineBankingSystem::deposit", accountNumber);
+        string key = idempotencyKey.empty() ? "" : "DEPOSIT:" + idempotencyKey;
+        size_t request = key.empty() ? 0 : requestHash(-1, accountNumber, amount, description);
+        bool replayed;
+        if (findReplay(key, request, replayed)) {
+            return replayed;
+        }
+        
+        Transaction t;
+        t.type = "DEPOSIT";
+        t.amount = amount;
+        t.timestamp = time(nullptr);
+        t.fromAccount = -1;
+        t.toAccount = accountNumber;
+        t.description = description;
+        
+        // Hot accounts queue unkeyed deposits without the writer lock; they
+        // become part of the ledger when settled, in a commit of their own.
+        // Keyed ones still go through the lock so a racing retry cannot
+        // credit twice.
+        HotAccount* hot = hotAccounts.find(accountNumber);
+        if (hot != nullptr && key.empty() && amount > 0) {
+            if (hot->credit(t)) {
+                SnapshotLedger::Commit commit = snapshots.beginCommit();
+                settleHot(commit, *hot);
+            }
+            return true;
+        }
+        
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        TRACE_INSTANT("writer lock acquired", accountNumber);
+        if (findReplay(key, request, replayed)) {
+            return replayed;
+        }
+        Account* account = findAccount(accountNumber);
+        if (account != nullptr && amount > 0) {
+            account->balance += amount;
+            t.id = account->transactions.size() + 1;
+            account->transactions.push_back(t);
+            searchIndex.add(accountNumber, t.id, description);
+            commit.publish(*account);
+            hotAccounts.noteDeposit(accountNumber, t.timestamp);
+            return remember(key, request);
+        }
+        return false;
+    }
+    
+    bool withdraw(int accountNumber, Money amount, string description) {
+        TRACE_SCOPE("OnlineBankingSystem::withdraw", accountNumber);
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        TRACE_INSTANT("writer lock acquired", accountNumber);
+        Account* account = findAccount(accountNumber);
+        Money debit = account != nullptr ? withdrawalDebit(*account, amount) : 0;
+        if (account != nullptr && (debit == 0 || debit > account->balance) && borrowPending(commit, *account)) {
+            debit = withdrawalDebit(*account, amount);
+        }
+        time_t now = time(nullptr);
+        if (account != nullptr && debit > 0 &&
+            velocity.allowWithdrawal(*account, amount, now)) {
+            account->balance -= debit;
+            velocity.recordWithdrawal(*account, amount, now);
+            
+            Transaction t;
+            t.id = account->transactions.size() + 1;
+            t.type = "WITHDRAWAL";
+            t.amount = amount;
+            t.timestamp = time(nullptr);
+            t.fromAccount = accountNumber;
+            t.toAccount = -1;
+            t.description = description;
+            
+            account->transactions.push_back(t);
+            searchIndex.add(accountNumber, t.id, description);
+            if (debit > amount) {
+                recordFee(*account, debit - amount, "Withdrawal fee");
+            }
+            commit.publish(*account);
+            return true;
+        }
+        return false;
+    }
+    
+    bool transfer(int fromAccount, int toAccount, Money amount, string description, const string& idempotencyKey = "") {
+        TRACE_SCOPE("OnlineBankingSystem::transfer", fromAccount);
+        string key = idempotencyKey.empty() ? "" : "TRANSFER:" + idempotencyKey;
+        size_t request = key.empty() ? 0 : requestHash(fromAccount, toAccount, amount, description);
+        bool replayed;
+        if (findReplay(key, request, replayed)) {
+            return replayed;
+        }
+        
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        TRACE_INSTANT("writer lock acquired", fromAccount);
+        if (findReplay(key, request, replayed)) {
+            return replayed;
+        }
+        Account* sender = findAccount(fromAccount);
+        Account* receiver = findAccount(toAccount);
+        Money debit = sender != nullptr ? transferDebit(*sender, amount) : 0;
+        if (sender != nullptr && (debit == 0 || debit > sender->balance) && borrowPending(commit, *sender)) {
+            debit = transferDebit(*sender, amount);
+        }
+        time_t now = time(nullptr);
+        
+        if (sender != nullptr && receiver != nullptr && 
+            sender != receiver && debit > 0 &&
+            velocity.allowTransfer(*sender, now)) {
+            
+            sender->balance -= debit;
+            velocity.recordTransfer(*sender, amount, now);
+            
+            Transaction t1;
+            t1.id = sender->transactions.size() + 1;
+            t1.type = "TRANSFER_OUT";
+            t1.amount = amount;
+            t1.timestamp = time(nullptr);
+            t1.fromAccount = fromAccount;
+            t1.toAccount = toAccount;
+            t1.description = description;
+            sender->transactions.push_back(t1);
+            searchIndex.add(fromAccount, t1.id, description);
+            if (debit > amount) {
+                recordFee(*sender, debit - amount, "Transfer fee");
+            }
+            
+            Transaction t2;
+            t2.type = "TRANSFER_IN";
+            t2.amount = amount;
+            t2.timestamp = time(nullptr);
+            t2.fromAccount = fromAccount;
+            t2.toAccount = toAccount;
+            t2.description = description;
+            
+            // Credited in this commit even when the receiver is hot, so the
+            // money is never missing from a published version
+            receiver->balance += amount;
+            t2.id = receiver->transactions.size() + 1;
+            receiver->transactions.push_back(t2);
+            searchIndex.add(toAccount, t2.id, description);
+            commit.publish(*sender);
+            commit.publish(*receiver);
+            return remember(key, request);
+        }
+        return false;
+    }
+    
+    void setVelocityLimits(AccountType type, const VelocityLimits& limits) {
+        velocity.setLimits(type, limits);
+    }
+    
+    EndOfDayResult runEndOfDay(time_t businessDate, const EndOfDayConfig& config = EndOfDayConfig()) {
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        settleAllHot(commit);
+        EndOfDayBatch batch(accounts, config);
+        EndOfDayResult result = batch.run(businessDate);
+        for (const auto& account : accounts) {
+            commit.publish(account);
+        }
+        return result;
+    }
+    
+    // Loads accounts from a migration CSV (see BulkAccountImporter) and
+    // publishes them to the statement snapshots and the search index in one
+    // go. Parsing and password hashing happen before the writer lock is
+    // taken, so commits keep going meanwhile.
+    ImportResult importAccounts(const string& path, unsigned threads = 0) {
+        BulkAccountImporter::Batch batch = BulkAccountImporter::load(path, threads);
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        size_t first = accounts.size();
+        ImportResult result = BulkAccountImporter::append(batch, accounts, nextAccountNumber);
+        for (size_t i = first; i < accounts.size(); i++) {
+            commit.publish(accounts[i]);
+        }
+        searchIndex.addAll([&](auto add) {
+            for (size_t i = first; i < accounts.size(); i++) {
+                for (const auto& t : accounts[i].transactions) {
+                    add(accounts[i].accountNumber, t.id, t.description);
+                }
+            }
+        });
+        return result;
+    }
+    
+    // Writes every account and transaction under `directory`, as of one
+    // snapshot taken after queued hot credits are settled.
+    ExportResult exportLedger(const string& directory, ExportFormat format, unsigned parts = 0) {
+        settleHotAccounts();
+        return ::exportLedger(snapshots.snapshot(), directory, format, parts);
+    }
+    
+    // Checks every balance against its history and the bank-wide totals,
+    // as of one snapshot; commits keep going meanwhile.
+    AuditResult auditLedger(unsigned threads = 0) {
+        settleHotAccounts();
+        return LedgerAudit::run(snapshots.snapshot(), threads);
+    }
+    
+    // Hot accounts: once an account takes `depositsPerSecond` deposits within
+    // one second it is promoted, and from then on its deposits are queued on
+    // per-thread stripes and folded in batches (0 turns promotion off).
+    void setHotAccountThreshold(unsigned depositsPerSecond) {
+        hotAccounts.setThreshold(depositsPerSecond);
+    }
+    
+    void promoteHotAccount(int accountNumber) {
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        if (findAccount(accountNumber) != nullptr) {
+            hotAccounts.promote(accountNumber);
+        }
+    }
+    
+    // Folds every queued hot-account credit into the ledger
+    void settleHotAccounts() {
+        SnapshotLedger::Commit commit = snapshots.beginCommit();
+        settleAllHot(commit);
+    }
+    
+    // Ships every commit to a standby process that connects on `socketPath`
+    void startReplicationPrimary(const string& socketPath) {
+        replicationPrimary.reset(new ReplicationPrimary(socketPath, snapshots, FIRST_ACCOUNT_NUMBER, idempotency));
+        snapshots.setCommitListener(replicationPrimary.get());
+        replicationPrimary->start();
+    }
+    
+    // Follows the primary on `socketPath`; only statements and searches
+    // should be served until promoteReplica().
+    void startReplica(const string& socketPath) {
+        replicationReplica.reset(new ReplicationReplica(socketPath, [this](const ReplicatedBatch& batch) {
+            applyReplicated(batch);
+        }));
+    }
+    
+    // Stops following the primary so this ledger can take writes
+    void promoteReplica() {
+        if (replicationReplica) {
+            replicationReplica->stop();
+        }
+    }
+    
+    bool isReplicationPrimary() const {
+        return replicationPrimary != nullptr;
+    }
+    
+    ReplicationStatus replicationStatus() {
+        if (replicationPrimary) {
+            return replicationPrimary->getStatus();
+        }
+        if (replicationReplica) {
+            return replicationReplica->getStatus();
+        }
+        return ReplicationStatus();
+    }
+    
+    // Point-in-time view for statements and bank-wide reports; never
+    // blocks writers.
+    SnapshotLedger::Snapshot snapshot() {
+        return snapshots.snapshot();
+    }
+    
+    // Finds transactions across all accounts by description words; a word
+    // ending in '*' is a prefix match.
+    vector<pair<int, Transaction>> searchTransactions(const string& query, size_t limit = 100) {
+        vector<pair<int, Transaction>> results;
+        SnapshotLedger::Snapshot snap = snapshots.snapshot();
+        for (const auto& ref : searchIndex.search(query, limit)) {
+            Transaction t;
+            if (snap.transaction(ref.accountNumber, ref.transactionId, t)) {
+                results.emplace_back(ref.accountNumber, t);
+            }
+        }
+        return results;
+    }
+    
+    void viewAccount(int accountNumber) {
+        TRACE_SCOPE("OnlineBankingSystem::viewAccount", accountNumber);
+        SnapshotLedger::Snapshot snap = snapshots.snapshot();
+        AccountView view;
+        if (snap.find(accountNumber, view)) {
+            HotAccount* hot = hotAccounts.find(accountNumber);
+            Money pending = hot != nullptr ? hot->pending() : 0;
+            const AccountView* account = &view;
+            cout << "\n----------------------------------------\n";
+            cout << "          ACCOUNT STATEMENT\n";
+            cout << "----------------------------------------\n";
+            cout << left << setw(20) << "Account Number:" << account->accountNumber << endl;
+            cout << setw(20) << "Account Holder:" << account->name << endl;
+            cout << setw(20) << "Account Type:" << (account->type == SAVINGS ? "Savings" : "Current") << endl;
+            cout << setw(20) << "Balance:" << formatMoney(account->balance) << " $" << endl;
+            if (pending > 0) {
+                cout << setw(20) << "Pending deposits:" << formatMoney(pending) << " $" << endl;
+            }
+            cout << setw(20) << "Creation Date:" << formatTime(account->creationDate) << endl;
+            cout << "----------------------------------------\n";
+            
+            if (!account->transactions.empty()) {
+                cout << "\nTRANSACTION HISTORY:\n";
+                cout << left << setw(8) << "ID" << setw(15) << "Type" 
+                     << setw(12) << "Amount" << setw(22) << "Date/Time" 
+                     << setw(12) << "From" << setw(12) << "To" << "Description\n";
+                cout << "------------------------------------------------------------\n";
+                
+                for (const auto& t : account->transactions) {
+                    cout << setw(8) << t.id << setw(15) << t.type 
+                         << setw(12) << formatMoney(t.amount)
+                         << setw(22) << formatTime(t.timestamp)
+                         << setw(12) << (t.fromAccount == -1 ? "N/A" : to_string(t.fromAccount))
+                         << setw(12) << (t.toAccount == -1 ? "N/A" : to_string(t.toAccount))
+                         << t.description << endl;
+                }
+                cout << "----------------------------------------\n";
+            } else {
+                cout << "\nNo transactions found for this account.\n";
+            }
+        } else {
+            cout << "\nError: Account not found!\n";
+        }
+    }
+};
+
+void displayMainMenu() {
+    clearScreen();
+    cout << "------------------------------------------\n";
+    cout << "       ONLINE BANKING SYSTEM - MENU\n";
+    cout << "------------------------------------------\n";
+    cout << "1. Create New Account\n";
+    cout << "2. Deposit Money\n";
+    cout << "3. Withdraw Money\n";
+    cout << "4. Transfer Money\n";
+    cout << "5. View Account Statement\n";
+    cout << "6. Search Transactions\n";
+    cout << "7. Run End-of-Day Batch\n";
+    cout << "8. Export Ledger\n";
+    cout << "9. Import Accounts\n";
+    cout << "10. Audit Ledger\n";
+    cout << "11. Replication Status\n";
+    cout << "12. Exit\n";
+    cout << "----------------------------------------\n";
+    cout << "Enter your choice (1-12): ";
+}
+
+void createAccountUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    string name, password;
+    int type;
+    
+    cout << "----------------------------------------\n";
+    cout << "          CREATE NEW ACCOUNT\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter your full name: ";
+    cin.ignore();
+    getline(cin, name);
+    
+    cout << "Enter password: ";
+    cin >> password;
+    
+    cout << "Select account type:\n";
+    cout << "1. Savings Account\n";
+    cout << "2. Current Account\n";
+    cout << "Enter choice (1-2): ";
+    cin >> type;
+    
+    while (type < 1 || type > 2) {
+        cout << "Invalid choice. Please enter 1 or 2: ";
+        cin >> type;
+    }
+    
+    int accNum = bank.createAccount(name, static_cast<AccountType>(type), password);
+    cout << "\nAccount created successfully!\n";
+    cout << "Your account number is: " << accNum << endl;
+}
+
+// Reads a dollars-and-cents amount; anything unparsable comes back as 0,
+// which every operation rejects
+Money readAmount() {
+    Money amount = 0;
+    if (!readMoney(cin, amount)) {
+        cin.clear();
+        return 0;
+    }
+    return amount;
+}
+
+// Asks for the account's password; false if it is wrong or locked out
+bool confirmPassword(OnlineBankingSystem& bank, int accountNumber) {
+    string password;
+    cout << "Enter password: ";
+    cin >> password;
+    try {
+        if (bank.verifyPassword(accountNumber, password).get()) {
+            return true;
+        }
+        cout << "\nIncorrect account number or password.\n";
+    } catch (const exception& e) {
+        cout << "\n" << e.what() << "\n";
+    }
+    return false;
+}
+
+void depositUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    int accountNumber;
+    Money amount;
+    string description;
+    
+    cout << "----------------------------------------\n";
+    cout << "              DEPOSIT MONEY\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter account number: ";
+    cin >> accountNumber;
+    
+    cout << "Enter amount to deposit: $";
+    amount = readAmount();
+    
+    cout << "Enter description: ";
+    cin.ignore();
+    getline(cin, description);
+    
+    if (bank.deposit(accountNumber, amount, description)) {
+        cout << "\nDeposit successful!\n";
+    } else {
+        cout << "\nDeposit failed. Invalid account or amount.\n";
+    }
+}
+
+void withdrawUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    int accountNumber;
+    Money amount;
+    string description;
+    
+    cout << "----------------------------------------\n";
+    cout << "             WITHDRAW MONEY\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter account number: ";
+    cin >> accountNumber;
+    if (!confirmPassword(bank, accountNumber)) {
+        return;
+    }
+    
+    cout << "Enter amount to withdraw: $";
+    amount = readAmount();
+    
+    cout << "Enter description: ";
+    cin.ignore();
+    getline(cin, description);
+    
+    if (bank.withdraw(accountNumber, amount, description)) {
+        cout << "\nWithdrawal successful!\n";
+    } else {
+        cout << "\nWithdrawal failed. Invalid account, amount, insufficient funds or limit reached.\n";
+    }
+}
+
+void transferUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    int fromAccount, toAccount;
+    Money amount;
+    string description;
+    
+    cout << "----------------------------------------\n";
+    cout << "             TRANSFER MONEY\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter your account number: ";
+    cin >> fromAccount;
+    if (!confirmPassword(bank, fromAccount)) {
+        return;
+    }
+    
+    cout << "Enter recipient account number: ";
+    cin >> toAccount;
+    
+    cout << "Enter amount to transfer: $";
+    amount = readAmount();
+    
+    cout << "Enter description: ";
+    cin.ignore();
+    getline(cin, description);
+    
+    if (bank.transfer(fromAccount, toAccount, amount, description)) {
+        cout << "\nTransfer successful!\n";
+    } else {
+        cout << "\nTransfer failed. Check account numbers, balance and transfer limits.\n";
+    }
+}
+
+void viewAccountUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    int accountNumber;
+    
+    cout << "----------------------------------------\n";
+    cout << "          VIEW ACCOUNT STATEMENT\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter account number: ";
+    cin >> accountNumber;
+    if (!confirmPassword(bank, accountNumber)) {
+        return;
+    }
+    
+    bank.viewAccount(accountNumber);
+}
+
+void searchTransactionsUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    string query;
+    
+    cout << "----------------------------------------\n";
+    cout << "          SEARCH TRANSACTIONS\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter search words (end a word with * for prefix): ";
+    cin.ignore();
+    getline(cin, query);
+    
+    vector<pair<int, Transaction>> results = bank.searchTransactions(query);
+    if (results.empty()) {
+        cout << "\nNo matching transactions found.\n";
+        return;
+    }
+    
+    cout << "\n" << left << setw(10) << "Account" << setw(8) << "ID" << setw(15) << "Type"
+         << setw(12) << "Amount" << "Description\n";
+    cout << "------------------------------------------------------------\n";
+    for (const auto& match : results) {
+        const Transaction& t = match.second;
+        cout << setw(10) << match.first << setw(8) << t.id << setw(15) << t.type
+             << setw(12) << formatMoney(t.amount) << t.description << endl;
+    }
+    cout << "----------------------------------------\n";
+    cout << results.size() << " transaction(s) shown.\n";
+}
+
+// Set by Ctrl+C while the end-of-day batch runs
+atomic<bool> endOfDayInterrupted(false);
+
+extern "C" void interruptEndOfDay(int) {
+    endOfDayInterrupted.store(true, memory_order_relaxed);
+}
+
+void endOfDayUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    
+    cout << "----------------------------------------\n";
+    cout << "          END-OF-DAY BATCH\n";
+    cout << "----------------------------------------\n";
+    cout << "Press Ctrl+C to stop; the next run resumes where this one left off.\n\n";
+    
+    EndOfDayConfig config;
+    config.cancel = &endOfDayInterrupted;
+    endOfDayInterrupted = false;
+    signal(SIGINT, interruptEndOfDay);
+    EndOfDayResult result = bank.runEndOfDay(time(nullptr), config);
+    signal(SIGINT, SIG_DFL);
+    
+    cout << left << setw(22) << "Accounts processed:" << result.accountsProcessed << endl;
+    if (result.accountsSkipped > 0) {
+        cout << setw(22) << "Already done today:" << result.accountsSkipped << endl;
+    }
+    cout << setw(22) << "Interest paid:" << formatMoney(result.interestPaid) << " $" << endl;
+    cout << setw(22) << "Fees charged:" << formatMoney(result.feesCharged) << " $" << endl;
+    cout << (result.completed ? "\nBatch completed.\n" : "\nBatch interrupted. Run again to resume.\n");
+}
+
+void auditLedgerUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    
+    cout << "----------------------------------------\n";
+    cout << "             LEDGER AUDIT\n";
+    cout << "----------------------------------------\n";
+    
+    AuditResult result = bank.auditLedger();
+    
+    cout << left << setw(22) << "Accounts checked:" << result.accountsChecked << endl;
+    cout << setw(22) << "Transactions checked:" << result.transactionsChecked << endl;
+    cout << setw(22) << "Total balances:" << formatMoney(result.totalRecorded) << " $" << endl;
+    cout << setw(22) << "Total from history:" << formatMoney(result.totalRecomputed) << " $" << endl;
+    cout << setw(22) << "Net external flow:" << formatMoney(result.externalNet()) << " $" << endl;
+    cout << setw(22) << "Transfers in/out:" << formatMoney(result.kindTotals[KIND_TRANSFER_IN]) << " / "
+         << formatMoney(result.kindTotals[KIND_TRANSFER_OUT]) << " $" << endl;
+    if (result.unknownTransactions > 0) {
+        cout << setw(22) << "Unknown types:" << result.unknownTransactions << endl;
+    }
+    
+    if (result.clean()) {
+        cout << "\nLedger reconciles.\n";
+        return;
+    }
+    cout << "\nLedger does NOT reconcile. " << result.mismatches.size() << " account(s) differ:\n";
+    for (size_t i = 0; i < result.mismatches.size() && i < 20; i++) {
+        const AuditMismatch& m = result.mismatches[i];
+        cout << "  " << setw(10) << m.accountNumber << " balance " << formatMoney(m.recorded)
+             << ", history " << formatMoney(m.recomputed) << endl;
+    }
+}
+
+void exportLedgerUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    string directory;
+    int format;
+    
+    cout << "----------------------------------------\n";
+    cout << "             EXPORT LEDGER\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "Enter output directory: ";
+    cin >> directory;
+    
+    cout << "Select format:\n";
+    cout << "1. CSV\n";
+    cout << "2. Columnar (.lcol)\n";
+    cout << "Enter choice (1-2): ";
+    cin >> format;
+    
+    while (format < 1 || format > 2) {
+        cout << "Invalid choice. Please enter 1 or 2: ";
+        cin >> format;
+    }
+    
+    try {
+        ExportResult result = bank.exportLedger(directory, static_cast<ExportFormat>(format));
+        cout << "\nExport completed.\n";
+        cout << left << setw(22) << "Accounts:" << result.accounts << endl;
+        cout << setw(22) << "Transactions:" << result.transactions << endl;
+        cout << setw(22) << "Files per kind:" << result.parts << endl;
+        cout << setw(22) << "Bytes written:" << result.bytes << endl;
+    } catch (const exception& e) {
+        cout << "\nExport failed: " << e.what() << endl;
+    }
+}
+
+void importAccountsUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    string path;
+    
+    cout << "----------------------------------------\n";
+    cout << "            IMPORT ACCOUNTS\n";
+    cout << "----------------------------------------\n";
+    
+    cout << "CSV columns: name,type,password,opening_balance\n";
+    cout << "History rows after each account: ,type,amount,timestamp,description\n";
+    cout << "(passwords as plaintext or stored hashes, pbkdf2-sha256$...)\n";
+    cout << "Enter file path: ";
+    cin.ignore();
+    getline(cin, path);
+    
+    try {
+        ImportResult result = bank.importAccounts(path);
+        cout << "\nImport completed.\n";
+        cout << left << setw(22) << "Accounts imported:" << result.imported << endl;
+        cout << setw(22) << "Transactions:" << result.transactions << endl;
+        cout << setw(22) << "Rows rejected:" << result.rejected << endl;
+        if (result.hashed > 0) {
+            cout << setw(22) << "Passwords hashed:" << result.hashed << endl;
+        }
+        if (result.imported > 0) {
+            cout << setw(22) << "Account numbers:" << result.firstAccountNumber
+                 << " - " << result.lastAccountNumber << endl;
+        }
+    } catch (const exception& e) {
+        cout << "\nImport failed: " << e.what() << endl;
+    }
+}
+
+void replicationStatusUI(OnlineBankingSystem& bank) {
+    clearScreen();
+    ReplicationStatus status = bank.replicationStatus();
+    
+    cout << "----------------------------------------\n";
+    cout << "          REPLICATION STATUS\n";
+    cout << "----------------------------------------\n";
+    if (bank.isReplicationPrimary()) {
+        cout << left << setw(22) << "Replica connected:" << (status.connected ? "Yes" : "No") << endl;
+        cout << setw(22) << "Last commit:" << status.seq << endl;
+        cout << setw(22) << "Applied by replica:" << status.ackedSeq << endl;
+        cout << setw(22) << "Replica lagging:"
+             << (status.lagging ? "Yes (dropped, re-syncs on reconnect)" : "No") << endl;
+        cout << setw(22) << "Dropped for lag:" << status.resyncs << endl;
+        return;
+    }
+    cout << left << setw(22) << "Primary connected:" << (status.connected ? "Yes" : "No") << endl;
+    cout << setw(22) << "Applied commit:" << status.seq << endl;
+    cout << setw(22) << "Last lag:" << fixed << setprecision(3) << status.lastLagMs << " ms" << endl;
+    cout << setw(22) << "Max lag:" << fixed << setprecision(3) << status.maxLagMs << " ms" << endl;
+    cout << setw(22) << "Re-syncs:" << status.resyncs << endl;
+}
+
+void pauseScreen() {
+    cout << "\nPress Enter to continue...";
+    cin.ignore();
+    cin.get();
+}
+
+void displayReplicaMenu() {
+    clearScreen();
+    cout << "------------------------------------------\n";
+    cout << "     ONLINE BANKING SYSTEM - STANDBY\n";
+    cout << "------------------------------------------\n";
+    cout << "1. View Account Statement\n";
+    cout << "2. Search Transactions\n";
+    cout << "3. Replication Status\n";
+    cout << "4. Promote to Primary\n";
+    cout << "5. Exit\n";
+    cout << "----------------------------------------\n";
+    cout << "Enter your choice (1-5): ";
+}
+
+// Read-only menu while following a primary. Returns true once promoted.
+bool runReplicaMenu(OnlineBankingSystem& bank) {
+    int choice;
+    
+    do {
+        displayReplicaMenu();
+        
+        while (!(cin >> choice)) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Invalid input. Please enter a number (1-5): ";
+        }
+        
+        switch(choice) {
+            case 1:
+                viewAccountUI(bank);
+                pauseScreen();
+                break;
+            case 2:
+                searchTransactionsUI(bank);
+                pauseScreen();
+                break;
+            case 3:
+                replicationStatusUI(bank);
+                pauseScreen();
+                break;
+            case 4:
+                bank.promoteReplica();
+                cout << "\nPromoted to primary. Writes are now accepted.\n";
+                pauseScreen();
+                return true;
+            case 5:
+                clearScreen();
+                cout << "\nThank you for using our banking system!\n";
+                break;
+            default:
+                cout << "Invalid choice. Please enter a number between 1 and 5.\n";
+                pauseScreen();
+        }
+        
+    } while (choice != 5);
+    
+    return false;
+}
+
+// Usage: main [--primary <socket> | --replica <socket>]
+// Built with -DENABLE_TRACING, SIGUSR1 dumps recent operations to obs.trace.
+int main(int argc, char* argv[]) {
+    OnlineBankingSystem bank;
+    int choice;
+    
+#if defined(ENABLE_TRACING) && defined(SIGUSR1)
+    // kill -USR1 <pid> writes obs.trace; see Trace::toChromeJson
+    Trace::flushOnSignal("obs.trace");
+#endif
+    
+    if (argc == 3) {
+        string mode = argv[1];
+        try {
+            if (mode == "--primary") {
+                bank.startReplicationPrimary(argv[2]);
+            } else if (mode == "--replica") {
+                bank.startReplica(argv[2]);
+                if (!runReplicaMenu(bank)) {
+                    return 0;
+                }
+            }
+        } catch (const exception& e) {
+            cout << "Replication error: " << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    do {
+        displayMainMenu();
+        
+        while (!(cin >> choice)) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Invalid input. Please enter a number (1-12): ";
+        }
+        
+        switch(choice) {
+            case 1:
+                createAccountUI(bank);
+                pauseScreen();
+                break;
+            case 2:
+                depositUI(bank);
+                pauseScreen();
+                break;
+            case 3:
+                withdrawUI(bank);
+                pauseScreen();
+                break;
+            case 4:
+                transferUI(bank);
+                pauseScreen();
+                break;
+            case 5:
+                viewAccountUI(bank);
+                pauseScreen();
+                break;
+            case 6:
+                searchTransactionsUI(bank);
+                pauseScreen();
+                break;
+            case 7:
+                endOfDayUI(bank);
+                pauseScreen();
+                break;
+            case 8:
+                exportLedgerUI(bank);
+                pauseScreen();
+                break;
+            case 9:
+                importAccountsUI(bank);
+                pauseScreen();
+                break;
+            case 10:
+                auditLedgerUI(bank);
+                pauseScreen();
+                break;
+            case 11:
+                replicationStatusUI(bank);
+                pauseScreen();
+                break;
+            case 12:
+                clearScreen();
+                cout << "\nThank you for using our banking system!\n";
+                break;
+            default:
+                cout << "Invalid choice. Please enter a number between 1 and 12.\n";
+                pauseScreen();
+        }
+        
+    } while (choice != 12);
+    
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Ledger audit throughput as worker threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread AuditBench.cpp -o AuditBench && ./AuditBench [transactions] [per_account]
+//
+// Publishes a ledger of 100M transactions by default, 100 per account, and
+// audits one snapshot of it per thread count, from one thread up to the
+// hardware thread count, printing transactions checked per second. Every run
+// must come out clean. The snapshot history takes roughly 120 bytes per
+// transaction (about 12 GB at the default size), so pass a smaller count on
+// smaller machines.
+#include "../LedgerAudit.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const int FIRST_ACCOUNT = 1000;
+
+int main(int argc, char* argv[]) {
+    size_t total = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000;
+    size_t perAccount = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100;
+    perAccount = max<size_t>(1, perAccount);
+    size_t count = (total + perAccount - 1) / perAccount;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    {
+        // The ledger keeps its own copy of each history, so one Account is
+        // reused for all of them
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        Account a;
+        a.type = SAVINGS;
+        a.creationDate = 0;
+        a.transactions.resize(perAccount);
+        for (size_t i = 0; i < count; i++) {
+            a.accountNumber = FIRST_ACCOUNT + (int)i;
+            a.balance = 0;
+            for (size_t k = 0; k < perAccount; k++) {
+                Transaction& t = a.transactions[k];
+                bool credit = k % 4 != 3;
+                t.id = (int)k + 1;
+                t.type = credit ? "DEPOSIT" : "WITHDRAWAL";
+                t.amount = 100 + (Money)((i + k) % 997);
+                t.timestamp = (time_t)k;
+                t.fromAccount = credit ? -1 : a.accountNumber;
+                t.toAccount = credit ? a.accountNumber : -1;
+                a.balance += credit ? t.amount : -t.amount;
+            }
+            commit.publish(a);
+        }
+    }
+    SnapshotLedger::Snapshot snapshot = ledger.snapshot();
+
+    printf("%zu accounts, %zu transactions, up to %u threads\n", count, count * perAccount, maxThreads);
+    printf("%8s %12s %18s\n", "threads", "seconds", "transactions/s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        auto start = chrono::steady_clock::now();
+        AuditResult result = LedgerAudit::run(snapshot, threads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (!result.clean() || result.transactionsChecked != count * perAccount) {
+            printf("run with %u threads: audit not clean or incomplete (%zu transactions checked)\n", threads,
+                   result.transactionsChecked);
+            return 1;
+        }
+        printf("%8u %12.3f %18.0f\n", threads, seconds, result.transactionsChecked / seconds);
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Throughput of the end-of-day batch as worker threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread EndOfDayBench.cpp -o EndOfDayBench && ./EndOfDayBench [accounts]
+//
+// Builds a ledger of half savings, half current accounts (default 2M) and
+// runs one business day per thread count, from one thread up to the
+// hardware thread count, printing accounts per second for each. Every run
+// is a new day, so each one does the full interest and fee pass.
+#include "../EndOfDay.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    vector<Account> accounts(count);
+    for (size_t i = 0; i < count; i++) {
+        Account& a = accounts[i];
+        a.accountNumber = 1000 + (int)i;
+        a.type = i % 2 ? CURRENT : SAVINGS;
+        a.balance = moneyUnits(100) + (Money)(i % 100000) * 37;
+        a.creationDate = 0;
+    }
+
+    time_t day = time(nullptr);
+    printf("%zu accounts, up to %u threads\n", count, maxThreads);
+    printf("%8s %12s %16s\n", "threads", "seconds", "accounts/s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        EndOfDayConfig config;
+        config.threads = threads;
+        EndOfDayBatch batch(accounts, config);
+
+        auto start = chrono::steady_clock::now();
+        EndOfDayResult result = batch.run(day);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        day += 86400;
+
+        if (!result.completed || result.accountsProcessed != count) {
+            printf("run with %u threads processed %zu of %zu accounts\n", threads, result.accountsProcessed, count);
+            return 1;
+        }
+        printf("%8u %12.3f %16.0f\n", threads, seconds, count / seconds);
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Export throughput in GB/s for both formats as writer threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread ExportBench.cpp -o ExportBench && ./ExportBench [directory] [accounts] [transactions]
+//
+// Publishes a ledger of accounts (default 100k) with a fixed number of
+// transactions each (default 50), then exports one snapshot of it into
+// `directory` (default: the current one) per format and part count, from one
+// part up to the hardware thread count. Prints rows and gigabytes written per
+// second; the files are removed after each run, so the numbers include
+// writing to the page cache but not necessarily reaching the disk.
+#include "../LedgerExport.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const int FIRST_ACCOUNT = 1000;
+
+int main(int argc, char* argv[]) {
+    string directory = argc > 1 ? argv[1] : ".";
+    size_t count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000;
+    size_t perAccount = argc > 3 ? strtoull(argv[3], nullptr, 10) : 50;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    vector<Account> accounts(count);
+    {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        for (size_t i = 0; i < count; i++) {
+            Account& a = accounts[i];
+            a.accountNumber = FIRST_ACCOUNT + (int)i;
+            a.name = "Account holder " + to_string(i);
+            a.type = i % 2 ? CURRENT : SAVINGS;
+            a.creationDate = 1700000000;
+            a.transactions.resize(perAccount);
+            for (size_t k = 0; k < perAccount; k++) {
+                Transaction& t = a.transactions[k];
+                t.id = (int)k + 1;
+                t.type = k % 3 == 0 ? "DEPOSIT" : k % 3 == 1 ? "WITHDRAWAL" : "TRANSFER_OUT";
+                t.amount = 100 + (Money)((i * 31 + k * 17) % 100000);
+                t.timestamp = 1700000000 + (time_t)(k * 3600);
+                t.fromAccount = k % 3 == 0 ? -1 : a.accountNumber;
+                t.toAccount = k % 3 == 1 ? -1 : k % 3 == 0 ? a.accountNumber : FIRST_ACCOUNT + (int)((i + k) % count);
+                t.description = k % 3 == 2 ? "Rent" : "ATM";
+                a.balance += k % 3 == 0 ? t.amount : -t.amount;
+            }
+            commit.publish(a);
+        }
+    }
+    SnapshotLedger::Snapshot snapshot = ledger.snapshot();
+
+    printf("%zu accounts, %zu transactions, up to %u parts\n", count, count * perAccount, maxThreads);
+    printf("%-9s %6s %10s %14s %10s\n", "format", "parts", "seconds", "rows/s", "GB/s");
+    for (ExportFormat format : {EXPORT_CSV, EXPORT_COLUMNAR}) {
+        for (unsigned parts = 1; parts <= maxThreads; parts *= 2) {
+            auto start = chrono::steady_clock::now();
+            ExportResult result = exportLedger(snapshot, directory, format, parts);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            printf("%-9s %6u %10.3f %14.0f %10.3f\n", format == EXPORT_CSV ? "csv" : "columnar", result.parts,
+                   seconds, (result.accounts + result.transactions) / seconds, result.bytes / seconds / 1e9);
+            for (unsigned part = 0; part < result.parts; part++) {
+                string suffix = "-" + to_string(part);
+                remove((directory + "/accounts" + suffix + ".csv").c_str());
+                remove((directory + "/transactions" + suffix + (format == EXPORT_CSV ? ".csv" : ".lcol")).c_str());
+            }
+            if (parts < maxThreads && parts * 2 > maxThreads) {
+                parts = maxThreads / 2;   // so the last row is the full machine
+            }
+        }
+    }
+    return 0;
+}
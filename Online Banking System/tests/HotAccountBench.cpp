@@ -0,0 +1,151 @@
+// Credits into one account per second as threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread HotAccountBench.cpp -o HotAccountBench && ./HotAccountBench [credits]
+//
+// Every thread credits the same receiving account (default 1M credits per
+// row, split between the threads), from one thread up to the hardware
+// thread count. "transfers/s" debits a sender of the thread's own and
+// credits the receiver in one commit, as transfer() does, so it stays on
+// the writer lock however hot the receiver is. "hot deposits/s" queues the
+// credits on the receiver's HotAccount stripes and folds them in when a
+// stripe asks for it, as deposit() does once the account is promoted. Each
+// row checks that the receiver's balance accounts for every credit.
+#include "../HotAccount.hpp"
+#include "../Snapshot.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const int FIRST_ACCOUNT = 1000;
+const Money AMOUNT = 100;
+
+Account newAccount(int number) {
+    Account a;
+    a.accountNumber = number;
+    a.type = CURRENT;
+    a.balance = moneyUnits(1000000);
+    a.creationDate = 0;
+    return a;
+}
+
+// Runs `perThread` calls of f(thread, i) on each of `threads` threads
+template <typename F>
+double timed(unsigned threads, size_t perThread, F f) {
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned k = 0; k < threads; k++) {
+        workers.emplace_back([&, k] {
+            for (size_t i = 0; i < perThread; i++) {
+                f(k, i);
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Receiver is FIRST_ACCOUNT, senders follow it
+double transfers(unsigned threads, size_t perThread) {
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    vector<Account> accounts;
+    for (unsigned k = 0; k <= threads; k++) {
+        accounts.push_back(newAccount(FIRST_ACCOUNT + (int)k));
+    }
+    {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        for (const auto& a : accounts) {
+            commit.publish(a);
+        }
+    }
+    Money opening = accounts[0].balance;
+
+    double seconds = timed(threads, perThread, [&](unsigned k, size_t) {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        Account& sender = accounts[k + 1];
+        Account& receiver = accounts[0];
+        Transaction t;
+        t.type = "TRANSFER_OUT";
+        t.amount = AMOUNT;
+        t.timestamp = time(nullptr);
+        t.fromAccount = sender.accountNumber;
+        t.toAccount = receiver.accountNumber;
+        sender.balance -= AMOUNT;
+        t.id = sender.transactions.size() + 1;
+        sender.transactions.push_back(t);
+        t.type = "TRANSFER_IN";
+        receiver.balance += AMOUNT;
+        t.id = receiver.transactions.size() + 1;
+        receiver.transactions.push_back(t);
+        commit.publish(sender);
+        commit.publish(receiver);
+    });
+
+    if (ledger.snapshot().balance(FIRST_ACCOUNT) != opening + AMOUNT * (Money)(threads * perThread)) {
+        printf("transfers with %u threads: receiver balance is off\n", threads);
+        exit(1);
+    }
+    return seconds;
+}
+
+double hotDeposits(unsigned threads, size_t perThread) {
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    Account receiver = newAccount(FIRST_ACCOUNT);
+    {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        commit.publish(receiver);
+    }
+    Money opening = receiver.balance;
+    HotAccount hot(FIRST_ACCOUNT);
+
+    double seconds = timed(threads, perThread, [&](unsigned, size_t) {
+        Transaction t;
+        t.type = "DEPOSIT";
+        t.amount = AMOUNT;
+        t.timestamp = time(nullptr);
+        t.fromAccount = -1;
+        t.toAccount = FIRST_ACCOUNT;
+        if (hot.credit(t)) {
+            SnapshotLedger::Commit commit = ledger.beginCommit();
+            if (hot.settle(receiver) > 0) {
+                commit.publish(receiver);
+            }
+        }
+    });
+    {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        if (hot.settle(receiver) > 0) {
+            commit.publish(receiver);
+        }
+    }
+
+    if (ledger.snapshot().balance(FIRST_ACCOUNT) != opening + AMOUNT * (Money)(threads * perThread)) {
+        printf("hot deposits with %u threads: receiver balance is off\n", threads);
+        exit(1);
+    }
+    return seconds;
+}
+
+int main(int argc, char* argv[]) {
+    size_t total = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    printf("%zu credits into one account per row, up to %u threads\n", total, maxThreads);
+    printf("%8s %16s %16s\n", "threads", "transfers/s", "hot deposits/s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        size_t perThread = max<size_t>(1, total / threads);
+        double count = (double)perThread * threads;
+        double transferSeconds = transfers(threads, perThread);
+        double depositSeconds = hotDeposits(threads, perThread);
+        printf("%8u %16.0f %16.0f\n", threads, count / transferSeconds, count / depositSeconds);
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    return 0;
+}
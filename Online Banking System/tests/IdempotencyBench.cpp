@@ -0,0 +1,67 @@
+// Throughput of the idempotency cache under a retry storm, as threads are
+// added.
+//
+//   g++ -std=c++17 -O3 -pthread IdempotencyBench.cpp -o IdempotencyBench && ./IdempotencyBench [requests] [retries]
+//
+// Each thread plays clients that send a keyed request, remember it on the
+// first attempt, then retry it a number of times (default 3), so most of the
+// load is hits on recent keys while new keys keep evicting old ones from the
+// default 64k-entry cache. Prints lookups per second and the share of
+// retries answered from the cache for each thread count.
+#include "../IdempotencyCache.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t retries = argc > 2 ? strtoull(argv[2], nullptr, 10) : 3;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    printf("%zu requests, %zu retries each, up to %u threads\n", requests, retries, maxThreads);
+    printf("%8s %12s %16s %10s\n", "threads", "seconds", "lookups/s", "replayed");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        IdempotencyCache cache;
+        atomic<size_t> replayed(0);
+        time_t now = time(nullptr);
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (unsigned w = 0; w < threads; w++) {
+            workers.emplace_back([&, w] {
+                size_t hits = 0;
+                string key;
+                for (size_t i = w; i < requests; i += threads) {
+                    key = "TRANSFER:client-" + to_string(i);
+                    size_t request = i * 2654435761u;
+                    bool result;
+                    if (cache.lookup(key, request, result, now) == IDEMPOTENCY_MISS) {
+                        cache.insert(key, request, true, now);
+                    }
+                    for (size_t r = 0; r < retries; r++) {
+                        hits += cache.lookup(key, request, result, now) == IDEMPOTENCY_HIT;
+                    }
+                }
+                replayed += hits;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        size_t lookups = requests * (retries + 1);
+        double share = retries == 0 ? 0 : 100.0 * replayed / (requests * retries);
+        printf("%8u %12.3f %16.0f %9.1f%%\n", threads, seconds, lookups / seconds, share);
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Bulk import throughput as parser threads are added.
+//
+//   g++ -std=c++17 -O3 -pthread ImportBench.cpp -o ImportBench && ./ImportBench [file] [accounts] [history]
+//
+// Writes a migration CSV of accounts (default 10M) with a number of history
+// rows each (default 2) to `file` (default import-bench.csv), then imports it
+// once per thread count, from one thread up to the hardware thread count,
+// and indexes the imported transactions for search. Prints rows per second
+// for the import and the time the index build took. All passwords are
+// stored hashes, so no hashing is measured. 10M accounts take several GB of
+// memory; pass a smaller count on small machines.
+#include "../BulkImport.hpp"
+#include "../TransactionIndex.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    string path = argc > 1 ? argv[1] : "import-bench.csv";
+    size_t count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000;
+    size_t history = argc > 3 ? strtoull(argv[3], nullptr, 10) : 2;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+
+    {
+        string hash = hashCredential("password", 1);
+        ofstream out(path, ios::binary);
+        out << "name,type,password,opening_balance\n";
+        for (size_t i = 0; i < count; i++) {
+            out << "\"Customer " << i << "\"," << (i % 2 ? "CURRENT" : "SAVINGS") << ',' << hash << ','
+                << 100 + i % 1000 << ".00\n";
+            for (size_t k = 0; k < history; k++) {
+                out << (k % 2 ? ",WITHDRAWAL,1.25," : ",DEPOSIT,20.00,") << 1600000000 + k * 86400
+                    << (k % 2 ? ",ATM\n" : ",Salary\n");
+            }
+        }
+        if (!out) {
+            printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    size_t rows = count * (history + 1);
+    printf("%zu accounts, %zu rows, up to %u threads\n", count, rows, maxThreads);
+    printf("%8s %12s %14s %14s\n", "threads", "seconds", "rows/s", "index s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        vector<Account> accounts;
+        int nextAccountNumber = 1000;
+
+        auto start = chrono::steady_clock::now();
+        ImportResult result = BulkAccountImporter::import(path, accounts, nextAccountNumber, threads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        TransactionIndex index;
+        start = chrono::steady_clock::now();
+        index.addAll([&](auto add) {
+            for (const auto& account : accounts) {
+                for (const auto& t : account.transactions) {
+                    add(account.accountNumber, t.id, t.description);
+                }
+            }
+        });
+        double indexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (result.imported != count || result.rejected != 0) {
+            printf("run with %u threads imported %zu of %zu accounts\n", threads, result.imported, count);
+            return 1;
+        }
+        printf("%8u %12.3f %14.0f %14.3f\n", threads, seconds, rows / seconds, indexSeconds);
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Login throughput, and what a login storm does to transfer latency.
+//
+//   g++ -std=c++17 -O3 -pthread LoginBench.cpp -o LoginBench && ./LoginBench [seconds] [transfers_per_second]
+//
+// One thread commits transfers between two accounts at a steady rate
+// (default 10000/s) while client threads keep the credential verifier pool
+// full of password checks. Each row is one pool size, from none (no logins,
+// the baseline) up to the hardware thread count, and prints the logins per
+// second and the p50/p99/max time to commit one transfer, writer lock
+// included. A pool as large as the machine shows what the limit protects.
+#include "../Snapshot.hpp"
+#include "../../Common/Credentials.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const int FIRST_ACCOUNT = 1000;
+
+struct Row {
+    size_t logins = 0;
+    vector<double> latencies;   // microseconds per transfer
+};
+
+Row run(unsigned poolThreads, double seconds, double rate, const string& stored) {
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    Account accounts[2];
+    for (int i = 0; i < 2; i++) {
+        accounts[i].accountNumber = FIRST_ACCOUNT + i;
+        accounts[i].type = CURRENT;
+        accounts[i].balance = moneyUnits(1000000);
+        accounts[i].creationDate = 0;
+    }
+    {
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        commit.publish(accounts[0]);
+        commit.publish(accounts[1]);
+    }
+
+    Row row;
+    atomic<bool> stop(false);
+    atomic<size_t> logins(0);
+    unique_ptr<CredentialVerifier> pool;
+    vector<thread> clients;
+    if (poolThreads > 0) {
+        pool.reset(new CredentialVerifier(poolThreads));
+        for (unsigned i = 0; i < poolThreads * 2; i++) {
+            clients.emplace_back([&] {
+                while (!stop.load()) {
+                    try {
+                        pool->verify("password", stored).get();
+                        logins++;
+                    } catch (const exception&) {
+                        this_thread::yield();   // queue full
+                    }
+                }
+            });
+        }
+    }
+
+    auto interval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1 / rate));
+    auto start = chrono::steady_clock::now();
+    auto end = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+    auto next = start;
+    for (int id = 1; next < end; id++, next += interval) {
+        this_thread::sleep_until(next);
+        auto begin = chrono::steady_clock::now();
+        {
+            SnapshotLedger::Commit commit = ledger.beginCommit();
+            Account& from = accounts[id % 2];
+            Account& to = accounts[1 - id % 2];
+            Transaction t;
+            t.id = id;
+            t.type = "TRANSFER";
+            t.amount = 100;
+            t.timestamp = 0;
+            t.fromAccount = from.accountNumber;
+            t.toAccount = to.accountNumber;
+            from.balance -= t.amount;
+            to.balance += t.amount;
+            from.transactions.push_back(t);
+            to.transactions.push_back(t);
+            commit.publish(from);
+            commit.publish(to);
+        }
+        row.latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+    }
+    row.logins = logins.load();
+
+    stop = true;
+    for (auto& t : clients) {
+        t.join();
+    }
+    return row;
+}
+
+double percentile(vector<double>& v, double p) {
+    size_t k = min(v.size() - 1, (size_t)(p * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 3;
+    double rate = argc > 2 ? atof(argv[2]) : 10000;
+    if (!(seconds > 0) || !(rate > 0)) {
+        printf("seconds and transfers per second must be positive\n");
+        return 1;
+    }
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    string stored = hashCredential("password");
+
+    printf("%.0f transfers/s for %.1fs per row, up to %u verifier threads\n", rate, seconds, maxThreads);
+    printf("%8s %12s %12s %12s %12s\n", "verifier", "logins/s", "p50 us", "p99 us", "max us");
+    for (unsigned threads = 0; threads <= maxThreads; threads = threads == 0 ? 1 : threads * 2) {
+        Row row = run(threads, seconds, rate, stored);
+        double worst = *max_element(row.latencies.begin(), row.latencies.end());
+        double p50 = percentile(row.latencies, 0.50);
+        double p99 = percentile(row.latencies, 0.99);
+        printf("%8u %12.1f %12.1f %12.1f %12.1f\n", threads, row.logins / seconds, p50, p99, worst);
+        if (threads > 0 && threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;   // so the last row is the full machine
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Concurrency test for SnapshotLedger: statement readers run against a
+// transfer storm and must only ever see whole commits.
+//
+//   g++ -std=c++17 -O2 -pthread SnapshotTest.cpp -o SnapshotTest && ./SnapshotTest
+//
+// Exits non-zero if any reader saw a torn state: a bank total that moved,
+// a balance that disagrees with its own history, or a transfer whose two
+// halves were not both visible.
+#include "../Snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const int FIRST_ACCOUNT = 1000;
+const int ACCOUNTS = 64;
+const Money OPENING = moneyUnits(1000);
+const int TRANSFERS = 200000;
+const int READERS = 4;
+
+Transaction makeTransaction(const Account& account, const string& type, Money amount, int from, int to) {
+    Transaction t;
+    t.id = account.transactions.size() + 1;
+    t.type = type;
+    t.amount = amount;
+    t.timestamp = 0;
+    t.fromAccount = from;
+    t.toAccount = to;
+    t.description = type;
+    return t;
+}
+
+void openAccounts(SnapshotLedger& ledger, vector<Account>& accounts) {
+    SnapshotLedger::Commit commit = ledger.beginCommit();
+    for (int i = 0; i < ACCOUNTS; i++) {
+        Account a;
+        a.accountNumber = FIRST_ACCOUNT + i;
+        a.name = "Account " + to_string(i);
+        a.type = SAVINGS;
+        a.balance = OPENING;
+        a.creationDate = 0;
+        a.transactions.push_back(makeTransaction(a, "DEPOSIT", OPENING, -1, a.accountNumber));
+        accounts.push_back(a);
+    }
+    for (const auto& a : accounts) {
+        commit.publish(a);
+    }
+}
+
+// Runs the transfers; returns transfers per second
+double transferStorm(SnapshotLedger& ledger, vector<Account>& accounts) {
+    mt19937 rng(42);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < TRANSFERS; i++) {
+        Account& from = accounts[rng() % ACCOUNTS];
+        Account& to = accounts[rng() % ACCOUNTS];
+        Money amount = 1 + rng() % moneyUnits(50);
+        if (&from == &to || from.balance < amount) {
+            continue;
+        }
+        SnapshotLedger::Commit commit = ledger.beginCommit();
+        from.balance -= amount;
+        from.transactions.push_back(makeTransaction(from, "TRANSFER_OUT", amount, from.accountNumber, to.accountNumber));
+        to.balance += amount;
+        to.transactions.push_back(makeTransaction(to, "TRANSFER_IN", amount, from.accountNumber, to.accountNumber));
+        commit.publish(from);
+        commit.publish(to);
+    }
+    return TRANSFERS / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Checks one snapshot end to end; returns the number of problems found
+int checkSnapshot(SnapshotLedger& ledger) {
+    SnapshotLedger::Snapshot snap = ledger.snapshot();
+    int problems = 0;
+    if (snap.totalBalance() != OPENING * ACCOUNTS) {
+        problems++;
+    }
+
+    Money sent = 0, received = 0;
+    for (int i = 0; i < ACCOUNTS; i++) {
+        AccountView view;
+        if (!snap.find(FIRST_ACCOUNT + i, view)) {
+            return problems + 1;
+        }
+        Money fromHistory = 0;
+        for (size_t t = 0; t < view.transactions.size(); t++) {
+            const Transaction& tx = view.transactions[t];
+            if (tx.id != (int)t + 1) {
+                problems++;
+            }
+            if (tx.type == "TRANSFER_OUT") {
+                fromHistory -= tx.amount;
+                sent += tx.amount;
+            } else {
+                fromHistory += tx.amount;
+                if (tx.type == "TRANSFER_IN") {
+                    received += tx.amount;
+                }
+            }
+        }
+        if (fromHistory != view.balance || view.balance != snap.balance(FIRST_ACCOUNT + i)) {
+            problems++;
+        }
+    }
+    if (sent != received) {
+        problems++;
+    }
+    return problems;
+}
+
+int main() {
+    double alone;
+    {
+        SnapshotLedger ledger(FIRST_ACCOUNT);
+        vector<Account> accounts;
+        openAccounts(ledger, accounts);
+        alone = transferStorm(ledger, accounts);
+    }
+
+    SnapshotLedger ledger(FIRST_ACCOUNT);
+    vector<Account> accounts;
+    openAccounts(ledger, accounts);
+
+    atomic<bool> done(false);
+    atomic<long> snapshots(0);
+    atomic<long> problems(0);
+    vector<thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                problems += checkSnapshot(ledger);
+                snapshots++;
+            }
+        });
+    }
+    double contended = transferStorm(ledger, accounts);
+    done = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    problems += checkSnapshot(ledger);
+
+    printf("writer: %.0f transfers/s alone, %.0f with %d readers\n", alone, contended, READERS);
+    printf("readers: %ld snapshots checked, %ld problems\n", snapshots.load(), problems.load());
+    if (problems.load() != 0 || snapshots.load() == 0) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
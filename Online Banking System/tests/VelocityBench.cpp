@@ -0,0 +1,76 @@
+// Cost of the velocity check that guards every withdrawal and transfer.
+//
+//   g++ -std=c++17 -O3 -pthread VelocityBench.cpp -o VelocityBench && ./VelocityBench [accounts] [operations]
+//
+// Spreads withdrawals over a number of accounts (default 100k) with the clock
+// moving forward a few seconds per operation, so the windows keep sliding and
+// buckets expire as they would in production. Prints the nanoseconds per
+// allowWithdrawal + recordWithdrawal pair, and for comparison the cost of
+// answering the same question by scanning each account's last day of
+// withdrawals, which is what the windows replace.
+#include "../VelocityLimiter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    size_t operations = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000;
+
+    vector<Account> accounts(count);
+    for (size_t i = 0; i < count; i++) {
+        accounts[i].accountNumber = 1000 + (int)i;
+        accounts[i].type = i % 2 ? CURRENT : SAVINGS;
+    }
+    mt19937 rng(42);
+    vector<unsigned> order(operations);
+    for (unsigned& o : order) {
+        o = rng() % count;
+    }
+
+    VelocityLimiter limiter;
+    limiter.setLimits(SAVINGS, {-1, -1, -1});
+    limiter.setLimits(CURRENT, {-1, -1, -1});
+    time_t start = 1700000000;
+    size_t allowed = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; i++) {
+        const Account& account = accounts[order[i]];
+        time_t now = start + (time_t)(i / 1000);
+        if (limiter.allowWithdrawal(account, 100, now)) {
+            limiter.recordWithdrawal(account, 100, now);
+            allowed++;
+        }
+    }
+    double windowNs = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / operations;
+
+    // Same answers from a per-account list of withdrawal times, trimmed to the
+    // last 24h on each access.
+    vector<deque<pair<time_t, Money>>> history(count);
+    size_t scanned = 0;
+    t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; i++) {
+        deque<pair<time_t, Money>>& h = history[order[i]];
+        time_t now = start + (time_t)(i / 1000);
+        while (!h.empty() && h.front().first <= now - 86400) {
+            h.pop_front();
+        }
+        Money total = 0;
+        for (const auto& w : h) {
+            total += w.second;
+        }
+        scanned += total > 0;
+        h.emplace_back(now, 100);
+    }
+    double scanNs = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / operations;
+
+    printf("%zu accounts, %zu withdrawals (%zu allowed, %zu with history)\n", count, operations, allowed, scanned);
+    printf("%-22s %10.1f ns/op\n", "sliding window", windowNs);
+    printf("%-22s %10.1f ns/op\n", "history scan", scanNs);
+    return 0;
+}